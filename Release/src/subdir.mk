@@ -5,12 +5,18 @@
 # Add inputs and outputs from these tool invocations to the build variables
 C_SRCS += \
 ../src/children.c \
+../src/ctree.c \
+../src/arena.c \
 ../src/choice.c \
 ../src/dup.c \
 ../src/expecting.c \
+../src/first.c \
+../src/flat.c \
 ../src/grammar.c \
 ../src/keyword.c \
+../src/keywords.c \
 ../src/kwcache.c \
+../src/memo.c \
 ../src/list.c \
 ../src/node.c \
 ../src/cleri.c \
@@ -22,6 +28,7 @@ C_SRCS += \
 ../src/regex.c \
 ../src/repeat.c \
 ../src/rule.c \
+../src/sax.c \
 ../src/sequence.c \
 ../src/this.c \
 ../src/token.c \
@@ -29,12 +36,18 @@ C_SRCS += \
 
 OBJS += \
 ./src/children.o \
+./src/ctree.o \
+./src/arena.o \
 ./src/choice.o \
 ./src/dup.o \
 ./src/expecting.o \
+./src/first.o \
+./src/flat.o \
 ./src/grammar.o \
 ./src/keyword.o \
+./src/keywords.o \
 ./src/kwcache.o \
+./src/memo.o \
 ./src/list.o \
 ./src/node.o \
 ./src/cleri.o \
@@ -46,6 +59,7 @@ OBJS += \
 ./src/regex.o \
 ./src/repeat.o \
 ./src/rule.o \
+./src/sax.o \
 ./src/sequence.o \
 ./src/this.o \
 ./src/token.o \
@@ -53,12 +67,18 @@ OBJS += \
 
 C_DEPS += \
 ./src/children.d \
+./src/ctree.d \
+./src/arena.d \
 ./src/choice.d \
 ./src/dup.d \
 ./src/expecting.d \
+./src/first.d \
+./src/flat.d \
 ./src/grammar.d \
 ./src/keyword.d \
+./src/keywords.d \
 ./src/kwcache.d \
+./src/memo.d \
 ./src/list.d \
 ./src/node.d \
 ./src/cleri.d \
@@ -70,6 +90,7 @@ C_DEPS += \
 ./src/regex.d \
 ./src/repeat.d \
 ./src/rule.d \
+./src/sax.d \
 ./src/sequence.d \
 ./src/this.d \
 ./src/token.d \
@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <cleri/cleri.h>
+#include "../json/json.h"
+
+#define NUM_PARSES 20000
+#define NUM_PRIO_PARSES 2000
+#define NUM_PRIO_TERMS 5
+#define NUM_EDITS 20
+#define NUM_EDIT_SIZES 2
+
+const int PrioTerms[NUM_PRIO_TERMS] = {10, 50, 100, 150, 190};
+const int EditItems[NUM_EDIT_SIZES] = {74, 13300};  /* ~8.9 KB and ~1.6 MB */
+
+const char * TestJSON =
+    "{\"Name\": \"Iris\", \"Age\": 4, \"Toys\": [\"ball\", \"bone\", 3.5], "
+    "\"Vaccinated\": true, \"Owner\": null, \"Scores\": [1, 2, 3, 4, 5]}";
+
+const char * TestLog =
+    "2026-10-17 06:23:26 GET /api/items?page=2 200 0.125 \"curl/8.5\"\n"
+    "2026-10-17 06:23:27 POST /api/items 201 0.031 \"Mozilla/5.0 (X11)\"\n"
+    "2026-10-17 06:23:29 DELETE /api/items/42 404 0.004 \"\\\"quoted\\\"\"\n";
+
+typedef struct
+{
+    cleri_grammar_t * grammar;
+    const char * str;
+    int failed;
+} job_t;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Grammar for lines of an access log. Unlike the JSON grammar, which only
+ * uses patterns with a native matcher, each regular expression in this
+ * grammar is matched by PCRE2.
+ */
+static cleri_grammar_t * compile_log_grammar(void)
+{
+    cleri_t * line = cleri_sequence(
+        0,
+        7,
+        cleri_regex(0, "^[0-9]{4}-[0-9]{2}-[0-9]{2}"),
+        cleri_regex(0, "^[0-9]{2}:[0-9]{2}:[0-9]{2}"),
+        cleri_choice(
+            0,
+            0,
+            4,
+            cleri_keyword(0, "GET", 0),
+            cleri_keyword(0, "POST", 0),
+            cleri_keyword(0, "PUT", 0),
+            cleri_keyword(0, "DELETE", 0)),
+        cleri_regex(0, "^/[^\\s?]*(?:\\?\\S*)?"),
+        cleri_regex(0, "^[1-5][0-9]{2}"),
+        cleri_regex(0, "^[0-9]+\\.[0-9]+"),
+        cleri_regex(0, "^\"(?:[^\"\\\\]|\\\\.)*\""));
+
+    return cleri_grammar(cleri_repeat(0, line, 0, 0), NULL);
+}
+
+/*
+ * Each thread parses the same string using the shared grammar.
+ */
+static void * work(void * arg)
+{
+    job_t * job = (job_t *) arg;
+    cleri_parse_t * pr;
+    int i;
+
+    for (i = 0; i < NUM_PARSES; i++)
+    {
+        pr = cleri_parse(job->grammar, job->str);
+        if (pr == NULL || !pr->is_valid)
+        {
+            job->failed = 1;
+        }
+        if (pr != NULL)
+        {
+            cleri_parse_free(pr);
+        }
+    }
+    return NULL;
+}
+
+static void bench_threads(
+        cleri_grammar_t * grammar,
+        const char * str,
+        int num_threads)
+{
+    pthread_t threads[num_threads];
+    job_t jobs[num_threads];
+    double start, elapsed;
+    int i, failed = 0;
+
+    start = now();
+    for (i = 0; i < num_threads; i++)
+    {
+        jobs[i].grammar = grammar;
+        jobs[i].str = str;
+        jobs[i].failed = 0;
+        pthread_create(&threads[i], NULL, &work, &jobs[i]);
+    }
+    for (i = 0; i < num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        failed |= jobs[i].failed;
+    }
+    elapsed = now() - start;
+
+    printf("threads: %2d  parses/sec: %10.0f%s\n",
+            num_threads,
+            num_threads * NUM_PARSES / elapsed,
+            failed ? "  (failed)" : "");
+}
+
+/*
+ * Parse a long expression like `ni or ni and ni or ...` with a prio element.
+ * Each term is tested by the prio, so this shows how the parse time grows
+ * with the number of terms. Expecting is disabled since only the parse time
+ * is of interest.
+ */
+static void bench_prio(cleri_grammar_t * grammar, int num_terms)
+{
+    char * expr = (char *) malloc(num_terms * 8 + 1);
+    cleri_parse_t * pr;
+    double start, elapsed;
+    int i, failed = 0;
+    size_t len = 0;
+
+    for (i = 0; i < num_terms; i++)
+    {
+        len += sprintf(expr + len, "%s", (i == 0) ? "ni" :
+                (i % 3) ? " or ni" : " and ni");
+    }
+
+    start = now();
+    for (i = 0; i < NUM_PRIO_PARSES; i++)
+    {
+        pr = cleri_parse2(grammar, expr, len, CLERI_FLAG_EXPECTING_DISABLED);
+        if (pr == NULL || !pr->is_valid)
+        {
+            failed = 1;
+        }
+        if (pr != NULL)
+        {
+            cleri_parse_free(pr);
+        }
+    }
+    elapsed = now() - start;
+
+    printf("terms: %4d  parses/sec: %10.0f%s\n",
+            num_terms,
+            NUM_PRIO_PARSES / elapsed,
+            failed ? "  (failed)" : "");
+    free(expr);
+}
+
+/*
+ * Parse a JSON array with num_items copies of TestJSON, and compare a full
+ * parse with cleri_parse_edit() after changing the age of the item in the
+ * middle of the array. The age is changed from 4 to 42 and back so the length
+ * of the string changes with each edit.
+ */
+static void bench_edit(cleri_grammar_t * grammar, int num_items)
+{
+    size_t n = strlen(TestJSON), len = 1, offset;
+    char * str = (char *) malloc(num_items * (n + 2) + 3);
+    cleri_parse_t * pr, * prev;
+    double start, full, edit;
+    int i, failed = 0;
+
+    str[0] = '[';
+    for (i = 0; i < num_items; i++)
+    {
+        len += sprintf(str + len, "%s%s", (i == 0) ? "" : ", ", TestJSON);
+    }
+    str[len++] = ']';
+    str[len] = '\0';
+
+    offset = (size_t) (strstr(str + len / 2, "\"Age\": ") - str) + 7;
+
+    start = now();
+    for (i = 0; i < NUM_EDITS; i++)
+    {
+        pr = cleri_parse2(grammar, str, len, 0);
+        if (pr == NULL || !pr->is_valid)
+        {
+            failed = 1;
+        }
+        if (pr != NULL)
+        {
+            cleri_parse_free(pr);
+        }
+    }
+    full = (now() - start) / NUM_EDITS;
+
+    prev = cleri_parse2(grammar, str, len, CLERI_FLAG_INCREMENTAL);
+    if (prev == NULL)
+    {
+        free(str);
+        return;
+    }
+
+    start = now();
+    for (i = 0; i < NUM_EDITS; i++)
+    {
+        if (i % 2 == 0)
+        {
+            /* insert a 2 after the 4 */
+            memmove(str + offset + 2, str + offset + 1, len - offset);
+            str[offset + 1] = '2';
+            len++;
+            pr = cleri_parse_edit(grammar, prev, str, len, offset + 1, 0);
+        }
+        else
+        {
+            /* delete the 2 */
+            memmove(str + offset + 1, str + offset + 2, len - offset - 1);
+            len--;
+            pr = cleri_parse_edit(grammar, prev, str, len, offset + 1, 1);
+        }
+        cleri_parse_free(prev);
+        if (pr == NULL)
+        {
+            failed = 1;
+            break;
+        }
+        failed |= !pr->is_valid;
+        prev = pr;
+    }
+    edit = (now() - start) / NUM_EDITS;
+
+    printf("bytes: %8zu  full parse: %9.3f ms  edit: %9.3f ms%s\n",
+            len,
+            full * 1e3,
+            edit * 1e3,
+            failed ? "  (failed)" : "");
+
+    if (pr != NULL)
+    {
+        cleri_parse_free(pr);
+    }
+    free(str);
+}
+
+int main(int argc, char * argv[])
+{
+    /* optional argument for the maximum number of threads */
+    long cores = (argc > 1) ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    int n;
+
+    /* one grammar is shared by all threads */
+    cleri_grammar_t * json_grammar = compile_grammar();
+    cleri_grammar_t * log_grammar = compile_log_grammar();
+
+    printf("json:\n");
+    for (n = 1; n <= cores && n <= 64; n *= 2)
+    {
+        bench_threads(json_grammar, TestJSON, n);
+    }
+
+    /* compare matching regular expressions with and without JIT */
+    printf("log, jit: enabled\n");
+    for (n = 1; n <= cores && n <= 64; n *= 2)
+    {
+        bench_threads(log_grammar, TestLog, n);
+    }
+
+    cleri_grammar_set_jit(log_grammar, false);
+
+    printf("log, jit: disabled\n");
+    for (n = 1; n <= cores && n <= 64; n *= 2)
+    {
+        bench_threads(log_grammar, TestLog, n);
+    }
+
+    /* long expressions, a prio parses itself at most 200 times within a
+     * rule (PRIO_MAX_RECURSION_DEPTH in prio.c), which is once for each term
+     * in this expression, so a parse of more than 201 terms returns NULL */
+    cleri_grammar_t * prio_grammar = cleri_grammar(cleri_prio(
+        0,
+        4,
+        cleri_keyword(0, "ni", 0),
+        cleri_sequence(0, 3,
+            cleri_token(0, "("),
+            CLERI_THIS,
+            cleri_token(0, ")")),
+        cleri_sequence(0, 3,
+            CLERI_THIS,
+            cleri_keyword(0, "or", 0),
+            CLERI_THIS),
+        cleri_sequence(0, 3,
+            CLERI_THIS,
+            cleri_keyword(0, "and", 0),
+            CLERI_THIS)), NULL);
+
+    printf("prio:\n");
+    for (n = 0; n < NUM_PRIO_TERMS; n++)
+    {
+        bench_prio(prio_grammar, PrioTerms[n]);
+    }
+
+    /* an edit re-uses the results of the previous parse */
+    printf("edit:\n");
+    for (n = 0; n < NUM_EDIT_SIZES; n++)
+    {
+        bench_edit(json_grammar, EditItems[n]);
+    }
+
+    /* cleanup */
+    cleri_grammar_free(json_grammar);
+    cleri_grammar_free(log_grammar);
+    cleri_grammar_free(prio_grammar);
+
+    return 0;
+}
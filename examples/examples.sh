@@ -10,3 +10,4 @@ echo -n "repeat:    " && cd ../repeat && gcc main.c -lcleri && ./a.out
 echo -n "sequence:  " && cd ../sequence && gcc main.c -lcleri && ./a.out
 echo -n "token:     " && cd ../token && gcc main.c -lcleri && ./a.out
 echo -n "tokens:    " && cd ../tokens && gcc main.c -lcleri && ./a.out
+echo "benchmark: " && cd ../benchmark && gcc main.c ../json/json.c -lcleri -lpthread && ./a.out
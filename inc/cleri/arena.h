@@ -0,0 +1,44 @@
+/*
+ * arena.h - bump allocator used for all allocations during a single parse.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#ifndef CLERI_ARENA_H_
+#define CLERI_ARENA_H_
+
+#include <stddef.h>
+
+#define CLERI__ARENA_ALIGN 16
+#define CLERI__ARENA_BLOCK_SZ 8192
+#define CLERI__ARENA_BINS 12    /* recycle bins for sizes up to 2048 bytes */
+
+/* typedefs */
+typedef struct cleri_arena_s cleri_arena_t;
+typedef struct cleri_arena_block_s cleri_arena_block_t;
+
+/* private functions */
+cleri_arena_t * cleri__arena_new(void);
+void * cleri__arena_alloc(cleri_arena_t * arena, size_t size);
+void cleri__arena_release(cleri_arena_t * arena, void * data, size_t size);
+void cleri__arena_reset(cleri_arena_t * arena);
+void cleri__arena_free(cleri_arena_t * arena);
+
+/* structs */
+struct cleri_arena_block_s
+{
+    cleri_arena_block_t * next;
+    size_t size;
+};
+
+struct cleri_arena_s
+{
+    char * pt;
+    size_t left;
+    cleri_arena_block_t * blocks;
+    cleri_arena_block_t * large;    /* blocks with a single allocation */
+    cleri_arena_block_t * spare;
+    void * bins[CLERI__ARENA_BINS];
+};
+
+#endif /* CLERI_ARENA_H_ */
@@ -1,5 +1,5 @@
 /*
- * children.h - linked list for keeping node results
+ * children.h - array of node results, linked for iterating
  *
  * author       : Jeroen van der Heijden
  * email        : jeroen@transceptor.technology
@@ -8,6 +8,7 @@
  * changes
  *  - initial version, 08-03-2016
  *  - refactoring, 17-06-2017
+ *  - contiguous array, 17-10-2026
  */
 #ifndef CLERI_CHILDREN_H_
 #define CLERI_CHILDREN_H_
@@ -17,11 +18,15 @@
 /* typedefs */
 typedef struct cleri_node_s cleri_node_t;
 typedef struct cleri_children_s cleri_children_t;
+typedef struct cleri_parse_s cleri_parse_t;
 
 /* private functions */
-cleri_children_t * cleri__children_new(void);
-void cleri__children_free(cleri_children_t * children);
-int cleri__children_add(cleri_children_t * children, cleri_node_t * node);
+cleri_children_t * cleri__children_new(cleri_parse_t * pr);
+void cleri__children_free(cleri_parse_t * pr, cleri_node_t * parent);
+int cleri__children_add(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_node_t * node);
 
 /* structs */
 struct cleri_children_s
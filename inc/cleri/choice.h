@@ -17,11 +17,15 @@
 #include <inttypes.h>
 #include <cleri/cleri.h>
 #include <cleri/olist.h>
+#include <cleri/keywords.h>
+#include <cleri/first.h>
 
 /* typedefs */
 typedef struct cleri_s cleri_t;
 typedef struct cleri_olist_s cleri_olist_t;
 typedef struct cleri_choice_s cleri_choice_t;
+typedef struct cleri_keywords_s cleri_keywords_t;
+typedef struct cleri_first_s cleri_first_t;
 
 /* public functions */
 #ifdef __cplusplus
@@ -39,6 +43,8 @@ struct cleri_choice_s
 {
     int most_greedy;
     cleri_olist_t * olist;
+    cleri_keywords_t * keywords;    /* NULL or a hash table for keywords */
+    cleri_first_t * first;          /* NULL or first bytes by alternative */
 };
 
 #endif /* CLERI_CHOICE_H_ */
\ No newline at end of file
@@ -14,6 +14,7 @@
 
 #include <cleri/expecting.h>
 #include <cleri/keyword.h>
+#include <cleri/keywords.h>
 #include <cleri/sequence.h>
 #include <cleri/optional.h>
 #include <cleri/choice.h>
@@ -26,7 +27,10 @@
 #include <cleri/grammar.h>
 #include <cleri/prio.h>
 #include <cleri/node.h>
+#include <cleri/ctree.h>
+#include <cleri/flat.h>
 #include <cleri/parse.h>
+#include <cleri/sax.h>
 #include <cleri/rule.h>
 #include <cleri/this.h>
 #include <cleri/ref.h>
@@ -48,6 +52,7 @@ typedef struct cleri_rule_s cleri_rule_t;
 typedef struct cleri_rule_store_s cleri_rule_store_t;
 typedef struct cleri_node_s cleri_node_t;
 typedef struct cleri_parse_s cleri_parse_t;
+typedef struct cleri_parser_s cleri_parser_t;
 typedef struct cleri_ref_s cleri_ref_t;
 typedef struct cleri_s cleri_t;
 typedef struct cleri_dup_s cleri_dup_t;
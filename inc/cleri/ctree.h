@@ -0,0 +1,59 @@
+/*
+ * ctree.h - compact copy of a parse tree using offsets in a single array.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#ifndef CLERI_CTREE_H_
+#define CLERI_CTREE_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <cleri/cleri.h>
+#include <cleri/node.h>
+#include <cleri/parse.h>
+
+#define CLERI__CTREE_OBJS_SZ 64     /* initial size of the object index */
+
+/* typedefs */
+typedef struct cleri_s cleri_t;
+typedef struct cleri_parse_s cleri_parse_t;
+typedef struct cleri_ctree_s cleri_ctree_t;
+typedef struct cleri_cnode_s cleri_cnode_t;
+
+/* public macro functions */
+#define cleri_ctree_obj(__ctree, __i) \
+    (__ctree->objs[__ctree->nodes[__i].obj])
+#define cleri_ctree_str(__ctree, __str, __i) \
+    ((__str) + __ctree->nodes[__i].pos)
+
+/* public functions */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+cleri_ctree_t * cleri_ctree_new(cleri_parse_t * pr);
+void cleri_ctree_free(cleri_ctree_t * ctree);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* structs */
+struct cleri_cnode_s
+{
+    uint32_t pos;           /* offset of the node in the parsed string */
+    uint32_t len;
+    uint32_t obj;           /* index in objs, 0 for the root node */
+    uint32_t end;           /* index of the first node after this subtree */
+};
+
+struct cleri_ctree_s
+{
+    uint32_t n;             /* number of nodes */
+    uint32_t nobjs;         /* number of objects */
+    cleri_cnode_t * nodes;  /* nodes in pre-order, nodes[0] is the root */
+    cleri_t ** objs;        /* objects by index, objs[0] is NULL */
+};
+
+#endif /* CLERI_CTREE_H_ */
@@ -15,8 +15,10 @@
 
 #include <stdlib.h>
 #include <inttypes.h>
+#include <stdbool.h>
 #include <cleri/olist.h>
 #include <cleri/cleri.h>
+#include <cleri/arena.h>
 
 #define CLERI__EXP_MODE_OPTIONAL 0
 #define CLERI__EXP_MODE_REQUIRED 1
@@ -26,9 +28,13 @@ typedef struct cleri_s cleri_t;
 typedef struct cleri_olist_s cleri_olist_t;
 typedef struct cleri_exp_modes_s cleri_exp_modes_t;
 typedef struct cleri_expecting_s cleri_expecting_t;
+typedef struct cleri_arena_s cleri_arena_t;
 
 /* private functions */
-cleri_expecting_t * cleri__expecting_new(const char * str);
+cleri_expecting_t * cleri__expecting_new(
+        cleri_arena_t * arena,
+        const char * str,
+        bool enabled);
 int cleri__expecting_update(
         cleri_expecting_t * expecting,
         cleri_t * cl_obj,
@@ -37,8 +43,8 @@ int cleri__expecting_set_mode(
         cleri_expecting_t * expecting,
         const char * str,
         int mode);
-void cleri__expecting_free(cleri_expecting_t * expecting);
 void cleri__expecting_combine(cleri_expecting_t * expecting);
+void cleri__expecting_free(cleri_expecting_t * expecting);
 
 /* structs */
 struct cleri_exp_modes_s
@@ -51,9 +57,12 @@ struct cleri_exp_modes_s
 struct cleri_expecting_s
 {
     const char * str;
+    const char * top;   /* furthest update since top was last set */
     cleri_olist_t * required;
     cleri_olist_t * optional;
     cleri_exp_modes_t * modes;
+    cleri_arena_t * arena;
+    bool enabled;
 };
 
 #endif /* CLERI_EXPECTING_H_ */
\ No newline at end of file
@@ -0,0 +1,41 @@
+/*
+ * first.h - bytes which can start a match of an element.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#ifndef CLERI_FIRST_H_
+#define CLERI_FIRST_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <cleri/cleri.h>
+
+/* bit table with bytes which can start a match */
+#define CLERI__FIRST_SET(__bits, __c) \
+    ((__bits)[(__c) >> 3] |= (uint8_t) (1 << ((__c) & 7)))
+#define CLERI__FIRST_HAS(__bits, __c) \
+    ((__bits)[(__c) >> 3] & (1 << ((__c) & 7)))
+
+/* typedefs */
+typedef struct cleri_s cleri_t;
+typedef struct cleri_parse_s cleri_parse_t;
+typedef struct cleri_first_s cleri_first_t;
+
+/* private functions */
+int cleri__first_prepare(cleri_t ** elements, size_t n);
+bool cleri__first_skip(
+        cleri_parse_t * pr,
+        cleri_first_t * first,
+        cleri_t * cl_obj,
+        const char * str);
+
+/* structs */
+struct cleri_first_s
+{
+    bool nullable;          /* true when the element can match nothing */
+    uint8_t bits[32];       /* bytes which can start a non empty match */
+};
+
+#endif /* CLERI_FIRST_H_ */
@@ -0,0 +1,51 @@
+/*
+ * flat.h - parse tree as an array of fixed size records without pointers.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#ifndef CLERI_FLAT_H_
+#define CLERI_FLAT_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <cleri/cleri.h>
+#include <cleri/node.h>
+#include <cleri/parse.h>
+
+/* flatten order */
+#define CLERI_FLAT_PREORDER 0   /* a node before its children */
+#define CLERI_FLAT_POSTORDER 1  /* a node after its children */
+
+/* record type for the root node, which has no element */
+#define CLERI_FLAT_TP_ROOT UINT32_MAX
+
+/* typedefs */
+typedef struct cleri_parse_s cleri_parse_t;
+typedef struct cleri_flat_s cleri_flat_t;
+
+/* public functions */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t cleri_parse_flatten(
+        cleri_parse_t * pr,
+        cleri_flat_t ** buf,
+        int order);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* structs */
+struct cleri_flat_s
+{
+    uint32_t gid;
+    uint32_t tp;            /* cleri_tp or CLERI_FLAT_TP_ROOT */
+    uint32_t pos;           /* offset of the node in the parsed string */
+    uint32_t len;
+    uint32_t nchildren;
+};
+
+#endif /* CLERI_FLAT_H_ */
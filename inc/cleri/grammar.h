@@ -12,11 +12,17 @@
 #ifndef CLERI_GRAMMAR_H_
 #define CLERI_GRAMMAR_H_
 
+#include <stdbool.h>
 #include <pcre2.h>
 #include <cleri/cleri.h>
 #include <cleri/olist.h>
 
 #define CLERI_DEFAULT_RE_KEYWORDS "^\\w+"
+#define CLERI__GRAMMAR_SEEN_SZ 64   /* initial size of the seen elements */
+
+/* keyword scanner table bits */
+#define CLERI__KW_FIRST 0x1     /* valid as first character of a keyword */
+#define CLERI__KW_NEXT 0x2      /* valid as next character of a keyword */
 
 /* typedefs */
 typedef struct cleri_s cleri_t;
@@ -28,6 +34,8 @@ extern "C" {
 #endif
 
 cleri_grammar_t * cleri_grammar(cleri_t * start, const char * re_keywords);
+void cleri_grammar_set_jit(cleri_grammar_t * grammar, bool jit);
+void cleri_grammar_set_stack_limit(cleri_grammar_t * grammar, size_t size);
 void cleri_grammar_free(cleri_grammar_t * grammar);
 
 #ifdef __cplusplus
@@ -39,7 +47,10 @@ struct cleri_grammar_s
 {
     cleri_t * start;
     pcre2_code * re_keywords;
-    pcre2_match_data * match_data;
+    bool jit;               /* use JIT compiled regular expressions */
+    bool kw_scan;           /* true when kw_table can be used for keywords */
+    unsigned char kw_table[256];
+    size_t stack_limit;     /* stack a parse may use, SIZE_MAX for no limit */
 };
 
 #endif /* CLERI_GRAMMAR_H_ */
\ No newline at end of file
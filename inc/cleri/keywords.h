@@ -0,0 +1,49 @@
+/*
+ * keywords.h - choice between keywords using a hash table.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#ifndef CLERI_KEYWORDS_H_
+#define CLERI_KEYWORDS_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <cleri/cleri.h>
+#include <cleri/olist.h>
+
+/* typedefs */
+typedef struct cleri_s cleri_t;
+typedef struct cleri_olist_s cleri_olist_t;
+typedef struct cleri_keywords_s cleri_keywords_t;
+
+/* public functions */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+cleri_t * cleri_keywords(uint32_t gid, size_t len, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* private functions */
+cleri_keywords_t * cleri__keywords_new(cleri_olist_t * olist);
+ssize_t cleri__keywords_find(
+        cleri_keywords_t * keywords,
+        const char * str,
+        size_t len);
+void cleri__keywords_free(cleri_keywords_t * keywords);
+
+/* structs */
+struct cleri_keywords_s
+{
+    size_t n;               /* number of keywords */
+    size_t mask;            /* number of slots - 1 */
+    uint32_t * slots;       /* index in keywords plus one, 0 when empty */
+    cleri_t ** keywords;    /* keyword elements in choice order */
+};
+
+#endif /* CLERI_KEYWORDS_H_ */
@@ -8,6 +8,7 @@
  * changes
  *  - initial version, 08-03-2016
  *  - refactoring, 17-06-2017
+ *  - hash table by position, 17-10-2026
  */
 #ifndef CLERI_KWCACHE_H_
 #define CLERI_KWCACHE_H_
@@ -16,21 +17,33 @@
 #include <cleri/cleri.h>
 #include <cleri/parse.h>
 
+#define CLERI__KWCACHE_INITIAL_SZ 64    /* number of slots */
+
 /* typedefs */
 typedef struct cleri_parse_s cleri_parse_t;
 typedef struct cleri_kwcache_s cleri_kwcache_t;
+typedef struct cleri_kwcache_entry_s cleri_kwcache_entry_t;
 
 /* private functions */
-cleri_kwcache_t * cleri__kwcache_new(void);
+cleri_kwcache_t * cleri__kwcache_new(cleri_parse_t * pr);
+void cleri__kwcache_free(cleri_parse_t * pr, cleri_kwcache_t * kwcache);
 ssize_t cleri__kwcache_match(cleri_parse_t * pr, const char * str);
-void cleri__kwcache_free(cleri_kwcache_t * kwcache);
 
 /* structs */
-struct cleri_kwcache_s
+struct cleri_kwcache_entry_s
 {
+    const char * str;       /* NULL when the slot is not used */
     size_t len;
-    const char * str;
-    cleri_kwcache_t * next;
+    size_t examined;
+};
+
+struct cleri_kwcache_s
+{
+    size_t hits;            /* number of keyword matches from the cache */
+    size_t misses;          /* number of keyword matches not in the cache */
+    size_t n;
+    size_t mask;
+    cleri_kwcache_entry_t * entries;
 };
 
 #endif /* CLERI_KWCACHE_H_ */
@@ -0,0 +1,79 @@
+/*
+ * memo.h - packrat memoization of parse results by element and position.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#ifndef CLERI_MEMO_H_
+#define CLERI_MEMO_H_
+
+#include <stddef.h>
+#include <cleri/cleri.h>
+#include <cleri/node.h>
+#include <cleri/parse.h>
+
+#define CLERI__MEMO_INITIAL_SZ 1024             /* number of slots */
+#define CLERI__MEMO_DEFAULT_MAX_SIZE 0x4000000  /* 64 MiB */
+
+/* entry states */
+#define CLERI__MEMO_NEW 0       /* result from the current parse */
+#define CLERI__MEMO_OLD 1       /* result from a previous parse */
+
+/* typedefs */
+typedef struct cleri_s cleri_t;
+typedef struct cleri_node_s cleri_node_t;
+typedef struct cleri_parse_s cleri_parse_t;
+typedef struct cleri_memo_s cleri_memo_t;
+typedef struct cleri_memo_entry_s cleri_memo_entry_t;
+
+/* private functions */
+cleri_memo_t * cleri__memo_new(cleri_parse_t * pr);
+cleri_memo_entry_t * cleri__memo_get(
+        cleri_memo_t * memo,
+        cleri_t * cl_obj,
+        const char * str);
+int cleri__memo_set(
+        cleri_parse_t * pr,
+        cleri_t * cl_obj,
+        const char * str,
+        cleri_node_t * node,
+        size_t len,
+        size_t ext,
+        size_t top);
+cleri_memo_t * cleri__memo_rebase(
+        cleri_parse_t * pr,
+        cleri_parse_t * prev,
+        size_t offset,
+        size_t deleted);
+
+/* structs */
+struct cleri_memo_entry_s
+{
+    cleri_t * cl_obj;       /* NULL when the slot is not used */
+    const char * str;
+    cleri_node_t * node;    /* result node or NULL when parsing failed */
+    size_t len;
+    size_t ext;             /* number of bytes examined from str */
+    size_t top;             /* furthest expecting update relative to str
+                               plus one, or 0 when there is no update */
+    int state;
+};
+
+struct cleri_memo_s
+{
+    size_t hits;            /* number of results taken from the memo */
+    size_t misses;          /* number of results not found in the memo */
+    size_t stored;          /* number of results stored in the memo */
+    size_t dropped;         /* results not stored because of max_size */
+    size_t reused;          /* results re-used from a previous parse */
+    size_t size;            /* current size of the table in bytes */
+    size_t skipped;         /* furthest skipped expecting update + 1 */
+    const char * limit;     /* when not NULL, only results with expecting
+                               updates before limit are used */
+    size_t max_size;
+    size_t n;
+    size_t mask;
+    cleri_memo_entry_t * entries;
+};
+
+#endif /* CLERI_MEMO_H_ */
@@ -22,14 +22,39 @@
 typedef struct cleri_s cleri_t;
 typedef struct cleri_children_s cleri_children_t;
 typedef struct cleri_node_s cleri_node_t;
+typedef struct cleri_parse_s cleri_parse_t;
 
 /* public macro function */
 #define cleri_node_has_children(__node) \
     (__node->children != NULL && __node->children->node != NULL)
+#define cleri_node_nchildren(__node) \
+    ((size_t) __node->nchildren)
+#define cleri_node_child(__node, __i) \
+    (__node->children[__i].node)
+
+/* private callback for cleri__node_walk(), end is 0 before the children */
+typedef int (*cleri__node_visit_t)(
+        cleri_node_t * node,
+        size_t idx,
+        size_t end,
+        void * data);
 
 /* private functions */
-cleri_node_t * cleri__node_new(cleri_t * cl_obj, const char * str, size_t len);
-void cleri__node_free(cleri_node_t * node);
+cleri_node_t * cleri__node_new(
+        cleri_parse_t * pr,
+        cleri_t * cl_obj,
+        const char * str,
+        size_t len);
+void cleri__node_free(cleri_parse_t * pr, cleri_node_t * node);
+void cleri__node_move(
+        cleri_parse_t * pr,
+        cleri_node_t * node,
+        const char * str);
+size_t cleri__node_export_count(cleri_parse_t * pr);
+int cleri__node_walk(
+        cleri_node_t * node,
+        cleri__node_visit_t visit,
+        void * data);
 
 /* private use as empty node */
 extern cleri_node_t * CLERI_EMPTY_NODE;
@@ -42,9 +67,11 @@ struct cleri_node_s
     size_t len;
     cleri_t * cl_obj;
     cleri_children_t * children;
+    uint32_t nchildren;
 
     /* private */
-    uint_fast8_t ref;
+    uint32_t ref : 31;
+    uint32_t gen : 1;   /* parse which has set str, see cleri__node_move() */
     int64_t result;
 };
 
@@ -22,7 +22,6 @@ typedef struct cleri_olist_s cleri_olist_t;
 /* private functions */
 cleri_olist_t * cleri__olist_new(void);
 int cleri__olist_append(cleri_olist_t * olist, cleri_t * cl_object);
-int cleri__olist_append_nref(cleri_olist_t * olist, cleri_t * cl_object);
 void cleri__olist_free(cleri_olist_t * olist);
 void cleri__olist_empty(cleri_olist_t * olist);
 void cleri__olist_cancel(cleri_olist_t * olist);
@@ -14,12 +14,26 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <cleri/cleri.h>
 #include <cleri/grammar.h>
 #include <cleri/node.h>
 #include <cleri/expecting.h>
 #include <cleri/kwcache.h>
 #include <cleri/rule.h>
+#include <cleri/arena.h>
+#include <cleri/memo.h>
+#include <cleri/sax.h>
+
+#define CLERI__JIT_STACK_START 32768    /* initial size of a JIT stack */
+#define CLERI__JIT_STACK_MAX 1048576    /* maximum size of a JIT stack */
+#define CLERI__PARSER_BUF_SZ 4096  /* initial size of a parser buffer */
+
+/* parse flags */
+#define CLERI_FLAG_VALIDATE 0x1     /* only validate, do not build a tree */
+#define CLERI_FLAG_EXPECTING_DISABLED 0x2   /* no expecting bookkeeping */
+#define CLERI_FLAG_MEMO 0x4         /* packrat memoization of all results */
+#define CLERI_FLAG_INCREMENTAL 0x8  /* memo which can be used for edits */
 
 /* typedefs */
 typedef struct cleri_s cleri_t;
@@ -29,6 +43,10 @@ typedef struct cleri_expecting_s cleri_expecting_t;
 typedef struct cleri_kwcache_s cleri_kwcache_t;
 typedef struct cleri_rule_store_s cleri_rule_store_t;
 typedef struct cleri_parse_s cleri_parse_t;
+typedef struct cleri_parser_s cleri_parser_t;
+typedef struct cleri_arena_s cleri_arena_t;
+typedef struct cleri_memo_s cleri_memo_t;
+typedef struct cleri_sax_ctx_s cleri_sax_ctx_t;
 
 /* public functions */
 #ifdef __cplusplus
@@ -36,14 +54,69 @@ extern "C" {
 #endif
 
 cleri_parse_t * cleri_parse(cleri_grammar_t * grammar, const char * str);
+cleri_parse_t * cleri_parse_n(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len);
+cleri_parse_t * cleri_parse2(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        int flags);
+cleri_parse_t * cleri_parse_edit(
+        cleri_grammar_t * grammar,
+        cleri_parse_t * prev,
+        const char * str,
+        size_t len,
+        size_t offset,
+        size_t deleted);
+int cleri_validate(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t * pos);
 void cleri_parse_free(cleri_parse_t * pr);
 void cleri_parse_expect_start(cleri_parse_t * pr);
+cleri_parser_t * cleri_parser_new(cleri_grammar_t * grammar, int flags);
+cleri_parse_t * cleri_parser_parse(
+        cleri_parser_t * parser,
+        const char * str,
+        size_t len);
+int cleri_parse_feed(cleri_parser_t * parser, const char * chunk, size_t len);
+cleri_parse_t * cleri_parse_finish(cleri_parser_t * parser);
+void cleri_parser_set_memo_max_size(
+        cleri_parser_t * parser,
+        size_t max_size);
+void cleri_parser_set_stack_limit(cleri_parser_t * parser, size_t size);
+int cleri_parser_set_gid_filter(
+        cleri_parser_t * parser,
+        const uint32_t * gids,
+        size_t n);
+void cleri_parser_free(cleri_parser_t * parser);
 
 #ifdef __cplusplus
 }
 #endif
 
+/* private macro function */
+#define cleri__parse_remaining(__pr, __str) \
+    ((__pr)->len - (size_t) ((__str) - (__pr)->str))
+
+/* mark n bytes from str as examined, used for incremental parsing */
+#define cleri__parse_examined(__pr, __str, __n)                             \
+do {                                                                        \
+    size_t __ext = (size_t) ((__str) - (__pr)->str) + (__n);                \
+    if (__ext > (__pr)->ext)                                                \
+    {                                                                       \
+        (__pr)->ext = __ext;                                                \
+    }                                                                       \
+} while (0)
+
 /* private functions */
+cleri_parse_t * cleri__parse_sax(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        cleri_sax_ctx_t * sax);
 cleri_node_t * cleri__parse_walk(
         cleri_parse_t * pr,
         cleri_node_t * parent,
@@ -63,6 +136,38 @@ struct cleri_parse_s
     pcre2_code * re_keywords;
     pcre2_match_data * match_data;
     cleri_kwcache_t * kwcache;
+
+    /* members above are part of the 0.9 layout, new ones are added below */
+    size_t len;
+    bool too_deep;  /* parsing stopped at pos, the input is nested too deep */
+    const unsigned char * kw_table;     /* NULL when re_keywords is used */
+    pcre2_match_context * match_context;
+    pcre2_jit_stack * jit_stack;
+    uint32_t re_options;    /* PCRE2_NO_JIT when JIT is disabled */
+    cleri_arena_t * arena;
+    int flags;
+    cleri_memo_t * memo;
+    size_t memo_max_size;
+    uintptr_t stack;    /* address of the stack at the start of the parse */
+    size_t stack_limit;
+    size_t ext;     /* examined part of the string, see memo.h */
+    bool gen;       /* flips with each edit, see cleri__node_move() */
+    bool gid_filter;    /* only nodes with a gid in gids are in the tree */
+    uint32_t * gids;    /* sorted gids, NULL when ngids is 0 */
+    size_t ngids;
+    cleri_sax_ctx_t * sax;  /* NULL when not used, see sax.c */
+};
+
+struct cleri_parser_s
+{
+    cleri_grammar_t * grammar;
+    cleri_parse_t * pr;
+    int flags;
+    char * buf;             /* chunks for cleri_parse_feed() */
+    size_t buf_len;
+    size_t buf_sz;
+    cleri_parse_t * feed;   /* parse of the chunks, NULL when not parsed */
+    bool finished;          /* cleri_parse_finish() has returned feed */
 };
 
 #endif /* CLERI_PARSE_H_ */
\ No newline at end of file
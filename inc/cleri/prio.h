@@ -18,11 +18,13 @@
 #include <cleri/cleri.h>
 #include <cleri/olist.h>
 #include <cleri/rule.h>
+#include <cleri/first.h>
 
 /* typedefs */
 typedef struct cleri_s cleri_t;
 typedef struct cleri_olist_s cleri_olist_t;
 typedef struct cleri_prio_s cleri_prio_t;
+typedef struct cleri_first_s cleri_first_t;
 
 /* public functions */
 #ifdef __cplusplus
@@ -39,6 +41,7 @@ cleri_t * cleri_prio(uint32_t gid, size_t len, ...);
 struct cleri_prio_s
 {
     cleri_olist_t * olist;
+    cleri_first_t * first;          /* NULL or first bytes by alternative */
 };
 
 #endif /* CLERI_PRIO_H_ */
\ No newline at end of file
@@ -16,12 +16,33 @@
 
 #include <pcre2.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <inttypes.h>
 #include <cleri/cleri.h>
 
+/* patterns for which a native matcher is used */
+#define CLERI__RE_INTEGER "^-?[0-9]+"
+#define CLERI__RE_FLOAT "^-?[0-9]+\\.?[0-9]+"
+#define CLERI__RE_IDENTIFIER "^[a-zA-Z_][a-zA-Z0-9_]*"
+#define CLERI__RE_STRING_SZ 32      /* size for a generated string pattern */
+
+/* matchers */
+#define CLERI__REGEX_PCRE2 0
+#define CLERI__REGEX_INTEGER 1
+#define CLERI__REGEX_FLOAT 2
+#define CLERI__REGEX_IDENTIFIER 3
+#define CLERI__REGEX_STRING 4
+
+/* table with bytes which can start a match */
+#define CLERI__REGEX_FIRST_SET(__first, __c) \
+    ((__first)[(__c) >> 3] |= (uint8_t) (1 << ((__c) & 7)))
+#define CLERI__REGEX_FIRST_HAS(__first, __c) \
+    ((__first)[(__c) >> 3] & (1 << ((__c) & 7)))
+
 /* typedefs */
 typedef struct cleri_s cleri_t;
 typedef struct cleri_regex_s cleri_regex_t;
+typedef struct cleri_parse_s cleri_parse_t;
 
 /* public functions */
 #ifdef __cplusplus
@@ -29,16 +50,38 @@ extern "C" {
 #endif
 
 cleri_t * cleri_regex(uint32_t gid, const char * pattern);
+cleri_t * cleri_integer(uint32_t gid);
+cleri_t * cleri_float(uint32_t gid);
+cleri_t * cleri_identifier(uint32_t gid);
+cleri_t * cleri_string(uint32_t gid, char quote, char escape);
 
 #ifdef __cplusplus
 }
 #endif
 
+/* private functions */
+int cleri__regex_match(
+        cleri_parse_t * pr,
+        pcre2_code * re,
+        const char * str,
+        size_t len,
+        uint32_t options);
+size_t cleri__regex_examined(
+        cleri_parse_t * pr,
+        pcre2_code * re,
+        const char * str,
+        int rc,
+        size_t len);
+
 /* structs */
 struct cleri_regex_s
 {
     pcre2_code * regex;
-    pcre2_match_data * match_data;
+    int matcher;            /* CLERI__REGEX_PCRE2 or a native matcher */
+    char quote;             /* quote character for CLERI__REGEX_STRING */
+    char escape;            /* escape character or 0 for no escaping */
+    uint32_t minlength;     /* minimal length of a match */
+    uint8_t first[32];      /* bit table with bytes which can start a match */
 };
 
 #endif /* CLERI_REGEX_H_ */
\ No newline at end of file
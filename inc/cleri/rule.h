@@ -19,12 +19,15 @@
 #include <cleri/node.h>
 #include <cleri/expecting.h>
 
+#define CLERI__RULE_TESTED_SZ 16    /* initial number of slots for tests */
+
 /* typedefs */
 typedef struct cleri_s cleri_t;
 typedef struct cleri_node_s cleri_node_t;
 typedef struct cleri_rule_tested_s cleri_rule_tested_t;
 typedef struct cleri_rule_store_s cleri_rule_store_t;
 typedef struct cleri_rule_s cleri_rule_t;
+typedef struct cleri_parse_s cleri_parse_t;
 
 /* enums */
 typedef enum cleri_rule_test_e
@@ -37,8 +40,9 @@ typedef enum cleri_rule_test_e
 /* private functions */
 cleri_t * cleri__rule(uint32_t gid, cleri_t * cl_obj);
 cleri_rule_test_t cleri__rule_init(
+        cleri_parse_t * pr,
         cleri_rule_tested_t ** target,
-        cleri_rule_tested_t * tested,
+        cleri_rule_store_t * rule,
         const char * str);
 
 /* structs */
@@ -46,14 +50,16 @@ struct cleri_rule_tested_s
 {
     const char * str;
     cleri_node_t * node;
-    cleri_rule_tested_t * next;
 } ;
 
 struct cleri_rule_store_s
 {
-    cleri_rule_tested_t * tested;
+    cleri_rule_tested_t ** tested;  /* tests by position, NULL when empty */
+    size_t n;                       /* number of tests */
+    size_t mask;                    /* number of slots - 1 */
     cleri_t * root_obj;
     size_t depth;
+    cleri_rule_tested_t * slots[CLERI__RULE_TESTED_SZ];
 };
 
 struct cleri_rule_s
@@ -0,0 +1,89 @@
+/*
+ * sax.h - parse a string and report the result using callbacks.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ *  - report elements while parsing, 17-10-2026
+ */
+#ifndef CLERI_SAX_H_
+#define CLERI_SAX_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <cleri/cleri.h>
+#include <cleri/grammar.h>
+#include <cleri/node.h>
+#include <cleri/rule.h>
+
+#define CLERI__SAX_WALK_SZ 64   /* initial number of walking elements */
+
+/* typedefs */
+typedef struct cleri_grammar_s cleri_grammar_t;
+typedef struct cleri_parse_s cleri_parse_t;
+typedef struct cleri_rule_store_s cleri_rule_store_t;
+typedef struct cleri_sax_s cleri_sax_t;
+typedef struct cleri_sax_walk_s cleri_sax_walk_t;
+typedef struct cleri_sax_ctx_s cleri_sax_ctx_t;
+typedef void (*cleri_sax_cb_t)(
+        void * arg,
+        uint32_t gid,
+        const char * str,
+        size_t len);
+
+/* public functions */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int cleri_parse_sax(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        const cleri_sax_t * sax,
+        void * arg,
+        size_t * pos);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* private functions */
+cleri_node_t * cleri__sax_walk(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_t * cl_obj,
+        cleri_rule_store_t * rule,
+        int mode);
+int cleri__sax_commit(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_node_t * node);
+
+/* structs */
+struct cleri_sax_s
+{
+    cleri_sax_cb_t on_enter;      /* before the children of an element */
+    cleri_sax_cb_t on_exit;       /* after the children of an element */
+    cleri_sax_cb_t on_terminal;   /* keyword, token, tokens or regex */
+};
+
+struct cleri_sax_walk_s
+{
+    cleri_node_t * node;    /* node of an element which walks a child */
+    bool fixed;             /* the node is in the tree of a valid string */
+    bool hold;              /* the node fails when the child fails */
+    bool keep;              /* the node keeps the child when complete */
+    bool entered;           /* on_enter is called for the node */
+};
+
+struct cleri_sax_ctx_s
+{
+    const cleri_sax_t * sax;
+    void * arg;
+    size_t n;               /* number of walking elements */
+    size_t sz;
+    cleri_sax_walk_t * walk;
+};
+
+#endif /* CLERI_SAX_H_ */
@@ -39,6 +39,7 @@ struct cleri_tlist_s
     const char * token;
     size_t len;
     cleri_tlist_t * next;
+    cleri_tlist_t * next_first; /* next token with the same first byte */
 };
 
 struct cleri_tokens_s
@@ -46,6 +47,7 @@ struct cleri_tokens_s
     char * tokens;
     char * spaced;
     cleri_tlist_t * tlist;
+    cleri_tlist_t * first[256]; /* tokens by first byte, largest first */
 };
 
 #endif /* CLERI_TOKENS_H_ */
\ No newline at end of file
@@ -0,0 +1,318 @@
+/*
+ * arena.c - bump allocator used for all allocations during a single parse.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ *
+ */
+#include <cleri/arena.h>
+#include <stdlib.h>
+
+#define ARENA_ROUND(__sz) \
+    (((__sz) + CLERI__ARENA_ALIGN - 1) & ~((size_t) CLERI__ARENA_ALIGN - 1))
+#define ARENA_HEADER_SZ ARENA_ROUND(sizeof(cleri_arena_block_t))
+#define ARENA_SMALL_BINS 8  /* bins by size, other bins by a power of two */
+#define ARENA_LARGE(__sz) ((__sz) > CLERI__ARENA_BLOCK_SZ / 4)
+
+static size_t ARENA_bin(size_t * size);
+static void * ARENA_grow(cleri_arena_t * arena, size_t size);
+static void * ARENA_large(cleri_arena_t * arena, size_t size);
+static cleri_arena_block_t * ARENA_spare(cleri_arena_t * arena, size_t size);
+static void ARENA_blocks_free(cleri_arena_block_t * block);
+
+/*
+ * Returns NULL in case an error has occurred.
+ */
+cleri_arena_t * cleri__arena_new(void)
+{
+    size_t i;
+    cleri_arena_t * arena = (cleri_arena_t *) malloc(sizeof(cleri_arena_t));
+    if (arena != NULL)
+    {
+        arena->pt = NULL;
+        arena->left = 0;
+        arena->blocks = NULL;
+        arena->large = NULL;
+        arena->spare = NULL;
+        for (i = 0; i < CLERI__ARENA_BINS; i++)
+        {
+            arena->bins[i] = NULL;
+        }
+    }
+    return arena;
+}
+
+/*
+ * Returns a pointer to at least size bytes or NULL in case an error has
+ * occurred. Memory is released to a recycle bin when it is returned using
+ * cleri__arena_release() and will be re-used by a next allocation of the
+ * same size. Large allocations get a dedicated block so these can be released
+ * as well.
+ */
+void * cleri__arena_alloc(cleri_arena_t * arena, size_t size)
+{
+    void * data;
+    size_t bin = ARENA_bin(&size);
+
+    if (bin < CLERI__ARENA_BINS && (data = arena->bins[bin]) != NULL)
+    {
+        arena->bins[bin] = *((void **) data);
+        return data;
+    }
+
+    if (bin == CLERI__ARENA_BINS)
+    {
+        return ARENA_large(arena, size);
+    }
+
+    if (size > arena->left)
+    {
+        return ARENA_grow(arena, size);
+    }
+
+    data = arena->pt;
+    arena->pt += size;
+    arena->left -= size;
+
+    return data;
+}
+
+/*
+ * Return memory to the arena. Memory is kept in a recycle bin, except for a
+ * large allocation where the block becomes a spare block.
+ */
+void cleri__arena_release(cleri_arena_t * arena, void * data, size_t size)
+{
+    cleri_arena_block_t ** pt = &arena->large;
+    cleri_arena_block_t * block;
+    size_t bin = ARENA_bin(&size);
+
+    if (bin < CLERI__ARENA_BINS)
+    {
+        *((void **) data) = arena->bins[bin];
+        arena->bins[bin] = data;
+        return;
+    }
+
+    block = (cleri_arena_block_t *) ((char *) data - ARENA_HEADER_SZ);
+    for (; *pt != NULL; pt = &(*pt)->next)
+    {
+        if (*pt == block)
+        {
+            *pt = block->next;
+            block->next = arena->spare;
+            arena->spare = block;
+            return;
+        }
+    }
+}
+
+/*
+ * Release all memory allocated from the arena at once. The blocks are kept
+ * as spare blocks so a next parse does not need to allocate new memory.
+ *
+ * Spare blocks which are not used since the previous reset are only kept up
+ * to the size of the blocks which are used, the others are destroyed. This
+ * way the arena keeps at most twice the memory of the last parse, instead of
+ * the memory of the largest parse ever.
+ */
+void cleri__arena_reset(cleri_arena_t * arena)
+{
+    size_t i, used = 0, kept = 0;
+    cleri_arena_block_t * next;
+    cleri_arena_block_t * spare = arena->spare;
+
+    arena->spare = NULL;
+
+    while (arena->blocks != NULL)
+    {
+        next = arena->blocks->next;
+        used += arena->blocks->size;
+        arena->blocks->next = arena->spare;
+        arena->spare = arena->blocks;
+        arena->blocks = next;
+    }
+
+    while (arena->large != NULL)
+    {
+        next = arena->large->next;
+        used += arena->large->size;
+        arena->large->next = arena->spare;
+        arena->spare = arena->large;
+        arena->large = next;
+    }
+
+    while (spare != NULL)
+    {
+        next = spare->next;
+        if (kept + spare->size > used)
+        {
+            free(spare);
+        }
+        else
+        {
+            kept += spare->size;
+            spare->next = arena->spare;
+            arena->spare = spare;
+        }
+        spare = next;
+    }
+
+    arena->pt = NULL;
+    arena->left = 0;
+
+    for (i = 0; i < CLERI__ARENA_BINS; i++)
+    {
+        arena->bins[i] = NULL;
+    }
+}
+
+/*
+ * Destroy the arena including all memory allocated from the arena.
+ * (parsing NULL is allowed)
+ */
+void cleri__arena_free(cleri_arena_t * arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    ARENA_blocks_free(arena->blocks);
+    ARENA_blocks_free(arena->large);
+    ARENA_blocks_free(arena->spare);
+    free(arena);
+}
+
+/*
+ * Returns the recycle bin for an allocation of size bytes and sets size to
+ * the number of bytes which are used for the allocation. Sizes above the
+ * small bins are rounded up to a power of two. Large allocations have no bin
+ * in which case CLERI__ARENA_BINS is returned.
+ */
+static size_t ARENA_bin(size_t * size)
+{
+    size_t bin = ARENA_SMALL_BINS;
+    size_t sz = CLERI__ARENA_ALIGN * ARENA_SMALL_BINS;
+
+    *size = (*size) ? ARENA_ROUND(*size) : CLERI__ARENA_ALIGN;
+
+    if (*size <= sz)
+    {
+        return *size / CLERI__ARENA_ALIGN - 1;
+    }
+
+    if (ARENA_LARGE(*size))
+    {
+        return CLERI__ARENA_BINS;
+    }
+
+    for (sz <<= 1; sz < *size; sz <<= 1)
+    {
+        bin++;
+    }
+
+    *size = sz;
+    return bin;
+}
+
+/*
+ * Take a new block, preferably a spare block, and return size bytes from
+ * this block. Returns NULL in case an error has occurred.
+ */
+static void * ARENA_grow(cleri_arena_t * arena, size_t size)
+{
+    cleri_arena_block_t * block = ARENA_spare(arena, CLERI__ARENA_BLOCK_SZ);
+
+    if (block == NULL)
+    {
+        block = (cleri_arena_block_t *) malloc(
+                ARENA_HEADER_SZ + CLERI__ARENA_BLOCK_SZ);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->size = CLERI__ARENA_BLOCK_SZ;
+    }
+
+    block->next = arena->blocks;
+    arena->blocks = block;
+
+    arena->pt = (char *) block + ARENA_HEADER_SZ + size;
+    arena->left = block->size - size;
+
+    return (char *) block + ARENA_HEADER_SZ;
+}
+
+/*
+ * Returns size bytes from a dedicated block, preferably a spare block, so the
+ * current block can still be used. Returns NULL in case an error has occurred.
+ */
+static void * ARENA_large(cleri_arena_t * arena, size_t size)
+{
+    cleri_arena_block_t * block = ARENA_spare(arena, size);
+
+    if (block == NULL)
+    {
+        block = (cleri_arena_block_t *) malloc(ARENA_HEADER_SZ + size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->size = size;
+    }
+
+    block->next = arena->large;
+    arena->large = block;
+
+    return (char *) block + ARENA_HEADER_SZ;
+}
+
+/*
+ * Returns the smallest spare block with at least size bytes or NULL when no
+ * such block is available. The block is removed from the spare blocks. Taking
+ * the smallest block prevents a small parse from using a block of a large
+ * parse, which then would be kept by cleri__arena_reset().
+ */
+static cleri_arena_block_t * ARENA_spare(cleri_arena_t * arena, size_t size)
+{
+    cleri_arena_block_t ** pt = &arena->spare;
+    cleri_arena_block_t ** best = NULL;
+    cleri_arena_block_t * block;
+
+    for (; *pt != NULL; pt = &(*pt)->next)
+    {
+        if ((*pt)->size >= size &&
+            (best == NULL || (*pt)->size < (*best)->size))
+        {
+            best = pt;
+            if ((*pt)->size == size)
+            {
+                break;
+            }
+        }
+    }
+
+    if (best == NULL)
+    {
+        return NULL;
+    }
+
+    block = *best;
+    *best = block->next;
+    return block;
+}
+
+/*
+ * Destroy a list of blocks.
+ */
+static void ARENA_blocks_free(cleri_arena_block_t * block)
+{
+    cleri_arena_block_t * next;
+    while (block != NULL)
+    {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+}
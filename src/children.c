@@ -1,5 +1,5 @@
 /*
- * children.c - linked list for keeping node results
+ * children.c - array of node results, linked for iterating
  *
  * author       : Jeroen van der Heijden
  * email        : jeroen@transceptor.technology
@@ -7,18 +7,29 @@
  *
  * changes
  *  - initial version, 08-03-2016
+ *  - contiguous array, 17-10-2026
  *
  */
 #include <stdlib.h>
+#include <string.h>
 #include <cleri/children.h>
+#include <cleri/parse.h>
+
+static int CHILDREN_append(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_node_t * node);
+static int CHILDREN_keep(cleri_parse_t * pr, uint32_t gid);
+static size_t CHILDREN_size(uint32_t n);
 
 /*
  * Returns NULL and in case an error has occurred.
  */
-cleri_children_t * cleri__children_new(void)
+cleri_children_t * cleri__children_new(cleri_parse_t * pr)
 {
-    cleri_children_t * children =
-            (cleri_children_t *) malloc(sizeof(cleri_children_t));
+    cleri_children_t * children = (cleri_children_t *) cleri__arena_alloc(
+            pr->arena,
+            sizeof(cleri_children_t));
     if (children != NULL)
     {
         children->node = NULL;
@@ -28,48 +39,169 @@ cleri_children_t * cleri__children_new(void)
 }
 
 /*
- * Appends a node to children.
+ * Appends a node to the children of parent. When only validating, no tree is
+ * created and the node is released instead. (parent has no children in this
+ * case)
+ *
+ * When elements are reported while parsing, the node might be reported and
+ * released instead, see cleri__sax_commit().
+ *
+ * When a gid filter is set and the gid of the node is not in the filter, the
+ * children of the node are appended instead of the node itself. The node is
+ * not released since the caller may still use the node; the memory is
+ * returned to the arena after parsing.
  *
  * Returns 0 when successful or -1 in case of an error.
  */
-int cleri__children_add(cleri_children_t * children, cleri_node_t * node)
+int cleri__children_add(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_node_t * node)
 {
-    if (children->node == NULL)
+    uint32_t i;
+    int rc;
+
+    if (pr->flags & CLERI_FLAG_VALIDATE)
     {
-        children->node = node;
+        cleri__node_free(pr, node);
         return 0;
     }
 
-    while (children->next != NULL)
+    /* a node which cannot be discarded anymore is reported and released */
+    if (pr->sax != NULL && (rc = cleri__sax_commit(pr, parent, node)))
     {
-        children = children->next;
+        return (rc == -1) ? -1 : 0;
     }
 
-    children->next = (cleri_children_t *) malloc(sizeof(cleri_children_t));
-    if (children->next == NULL)
+    if (!pr->gid_filter || CHILDREN_keep(pr, node->cl_obj->gid))
     {
-        return -1;
+        return CHILDREN_append(pr, parent, node);
     }
-    else
+
+    for (i = 0; node->children != NULL && i < node->nchildren; i++)
     {
-        children->next->node = node;
-        children->next->next = NULL;
+        /* the child is referenced by both the node and parent */
+        node->children[i].node->ref++;
+        if (CHILDREN_append(pr, parent, node->children[i].node))
+        {
+            node->children[i].node->ref--;
+            return -1;
+        }
     }
     return 0;
 }
 
 /*
- * Destroy children.
+ * Release the children of parent so they can be re-used within the same
+ * parse.
+ */
+void cleri__children_free(cleri_parse_t * pr, cleri_node_t * parent)
+{
+    uint32_t i;
+    cleri_children_t * children = parent->children;
+
+    if (children == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < parent->nchildren; i++)
+    {
+        cleri__node_free(pr, children[i].node);
+    }
+    cleri__arena_release(
+            pr->arena,
+            children,
+            sizeof(cleri_children_t) * CHILDREN_size(parent->nchildren));
+}
+
+/*
+ * Returns the number of allocated children for n children. (the array starts
+ * with one child and doubles in size when full)
  */
-void cleri__children_free(cleri_children_t * children)
+static size_t CHILDREN_size(uint32_t n)
 {
-    cleri_children_t * next;
-    while (children != NULL)
+    size_t sz = 1;
+    while (sz < n)
     {
-        next = children->next;
-        cleri__node_free(children->node);
-        free(children);
-        children = next;
+        sz <<= 1;
     }
+    return sz;
 }
 
+/*
+ * Appends a node to the children of parent. The children are stored in one
+ * array which doubles in size when full, so appending is amortized O(1). The
+ * next pointers link each child to the following one so the children can
+ * still be used as a linked list.
+ *
+ * Returns 0 when successful or -1 in case of an error.
+ */
+static int CHILDREN_append(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_node_t * node)
+{
+    cleri_children_t * children;
+    uint32_t i, n = parent->nchildren;
+
+    if (n && (n & (n - 1)) == 0)
+    {
+        /* the array is full since the size is a power of two */
+        if (n > UINT32_MAX / 2)
+        {
+            return -1;
+        }
+
+        children = (cleri_children_t *) cleri__arena_alloc(
+                pr->arena,
+                sizeof(cleri_children_t) * n * 2);
+        if (children == NULL)
+        {
+            return -1;
+        }
+
+        memcpy(children, parent->children, sizeof(cleri_children_t) * n);
+        for (i = 1; i < n; i++)
+        {
+            children[i - 1].next = children + i;
+        }
+        cleri__arena_release(
+                pr->arena,
+                parent->children,
+                sizeof(cleri_children_t) * n);
+        parent->children = children;
+    }
+
+    children = parent->children;
+    if (n)
+    {
+        children[n - 1].next = children + n;
+    }
+    children[n].node = node;
+    children[n].next = NULL;
+    parent->nchildren = n + 1;
+
+    return 0;
+}
+
+/*
+ * Returns 1 when gid is in the gid filter of pr, or 0 if not.
+ */
+static int CHILDREN_keep(cleri_parse_t * pr, uint32_t gid)
+{
+    size_t lo = 0, hi = pr->ngids, mid;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (pr->gids[mid] < gid)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo < pr->ngids && pr->gids[lo] == gid;
+}
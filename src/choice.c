@@ -12,6 +12,7 @@
  */
 #include <cleri/choice.h>
 #include <cleri/node.h>
+#include <cleri/kwcache.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -36,6 +37,19 @@ static cleri_node_t * CHOICE_parse_first_match(
         cleri_t * cl_obj,
         cleri_rule_store_t * rule);
 
+static cleri_node_t * CHOICE_parse_keywords(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_t * cl_obj,
+        cleri_rule_store_t * rule);
+
+static int CHOICE_keywords_expecting(
+        cleri_parse_t * pr,
+        cleri_keywords_t * keywords,
+        const char * str,
+        ssize_t found,
+        size_t n);
+
 /*
  * Returns NULL in case an error has occurred.
  */
@@ -64,6 +78,8 @@ cleri_t * cleri_choice(uint32_t gid, int most_greedy, size_t len, ...)
     }
 
     cl_object->via.choice->most_greedy = most_greedy;
+    cl_object->via.choice->keywords = NULL;
+    cl_object->via.choice->first = NULL;
     cl_object->via.choice->olist = cleri__olist_new();
 
     if (cl_object->via.choice->olist == NULL)
@@ -96,6 +112,8 @@ cleri_t * cleri_choice(uint32_t gid, int most_greedy, size_t len, ...)
 static void CHOICE_free(cleri_t * cl_object)
 {
     cleri__olist_free(cl_object->via.choice->olist);
+    cleri__keywords_free(cl_object->via.choice->keywords);
+    free(cl_object->via.choice->first);
     free(cl_object->via.choice);
 }
 
@@ -108,6 +126,10 @@ static cleri_node_t * CHOICE_parse(
         cleri_t * cl_obj,
         cleri_rule_store_t * rule)
 {
+    if (cl_obj->via.choice->keywords != NULL)
+    {
+        return CHOICE_parse_keywords(pr, parent, cl_obj, rule);
+    }
     return (cl_obj->via.choice->most_greedy) ?
             CHOICE_parse_most_greedy(pr, parent, cl_obj, rule) :
             CHOICE_parse_first_match(pr, parent, cl_obj, rule);
@@ -126,12 +148,19 @@ static cleri_node_t * CHOICE_parse_most_greedy(
     cleri_node_t * node;
     cleri_node_t * rnode;
     cleri_node_t * mg_node = NULL;
+    cleri_first_t * first = cl_obj->via.choice->first;
     const char * str = parent->str + parent->len;
+    size_t i;
 
     olist = cl_obj->via.choice->olist;
-    while (olist != NULL)
+    for (i = 0; olist != NULL; i++, olist = olist->next)
     {
-        if ((node = cleri__node_new(cl_obj, str, 0)) == NULL)
+        if (first != NULL &&
+            cleri__first_skip(pr, first + i, olist->cl_obj, str))
+        {
+            continue;
+        }
+        if ((node = cleri__node_new(pr, cl_obj, str, 0)) == NULL)
         {
             pr->is_valid = -1;
             return NULL;
@@ -144,24 +173,35 @@ static cleri_node_t * CHOICE_parse_most_greedy(
                 CLERI__EXP_MODE_REQUIRED);
         if (rnode != NULL && (mg_node == NULL || node->len > mg_node->len))
         {
-            cleri__node_free(mg_node);
+            cleri__node_free(pr, mg_node);
             mg_node = node;
+
+            /* no other alternative can be longer when the end of the string
+             * is reached, but the other alternatives might still add expected
+             * elements at the end so this is only done with expecting
+             * disabled */
+            if (!pr->expecting->enabled &&
+                mg_node->len == cleri__parse_remaining(pr, str))
+            {
+                /* the result might change when the string is extended */
+                cleri__parse_examined(pr, str, mg_node->len + 1);
+                break;
+            }
         }
         else
         {
-            cleri__node_free(node);
+            cleri__node_free(pr, node);
         }
-        olist = olist->next;
     }
     if (mg_node != NULL)
     {
         parent->len += mg_node->len;
-        if (cleri__children_add(parent->children, mg_node))
+        if (cleri__children_add(pr, parent, mg_node))
         {
              /* error occurred, reverse changes set mg_node to NULL */
             pr->is_valid = -1;
             parent->len -= mg_node->len;
-            cleri__node_free(mg_node);
+            cleri__node_free(pr, mg_node);
             mg_node = NULL;
         }
     }
@@ -180,16 +220,24 @@ static cleri_node_t * CHOICE_parse_first_match(
     cleri_olist_t * olist;
     cleri_node_t * node;
     cleri_node_t * rnode;
+    cleri_first_t * first = cl_obj->via.choice->first;
+    const char * str = parent->str + parent->len;
+    size_t i;
 
     olist = cl_obj->via.choice->olist;
-    node = cleri__node_new(cl_obj, parent->str + parent->len, 0);
+    node = cleri__node_new(pr, cl_obj, str, 0);
     if (node == NULL)
     {
         pr->is_valid = -1;
         return NULL;
     }
-    while (olist != NULL)
+    for (i = 0; olist != NULL; i++, olist = olist->next)
     {
+        if (first != NULL &&
+            cleri__first_skip(pr, first + i, olist->cl_obj, str))
+        {
+            continue;
+        }
         rnode = cleri__parse_walk(
                 pr,
                 node,
@@ -199,18 +247,148 @@ static cleri_node_t * CHOICE_parse_first_match(
         if (rnode != NULL)
         {
             parent->len += node->len;
-            if (cleri__children_add(parent->children, node))
+            if (cleri__children_add(pr, parent, node))
             {
                  /* error occurred, reverse changes set mg_node to NULL */
                 pr->is_valid = -1;
                 parent->len -= node->len;
-                cleri__node_free(node);
+                cleri__node_free(pr, node);
                 node = NULL;
             }
             return node;
         }
-        olist = olist->next;
     }
-    cleri__node_free(node);
+    cleri__node_free(pr, node);
     return NULL;
 }
+
+/*
+ * Returns a node or NULL. In case of an error pr->is_valid is set to -1.
+ *
+ * Used for a choice with only keyword elements. Only the keyword which
+ * matches the word at the position is walked. The result is the same as
+ * trying each keyword; a matching keyword always has the length of the word,
+ * so also with most greedy the first matching keyword is chosen.
+ */
+static cleri_node_t * CHOICE_parse_keywords(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_t * cl_obj,
+        cleri_rule_store_t * rule)
+{
+    cleri_keywords_t * keywords = cl_obj->via.choice->keywords;
+    cleri_node_t * node;
+    const char * str = parent->str + parent->len;
+    ssize_t match_len, found;
+
+    if ((match_len = cleri__kwcache_match(pr, str)) < 0)
+    {
+        pr->is_valid = -1; /* error occurred */
+        return NULL;
+    }
+
+    found = (match_len == 0) ? -1 : cleri__keywords_find(
+            keywords,
+            str,
+            (size_t) match_len);
+
+    /* the keywords which are tried without a match are expected */
+    if (CHOICE_keywords_expecting(
+            pr,
+            keywords,
+            str,
+            found,
+            (found == -1 || cl_obj->via.choice->most_greedy) ?
+                    keywords->n : (size_t) found))
+    {
+        pr->is_valid = -1;
+        return NULL;
+    }
+
+    if (found == -1)
+    {
+        return NULL;
+    }
+
+    if ((node = cleri__node_new(pr, cl_obj, str, 0)) == NULL)
+    {
+        pr->is_valid = -1;
+        return NULL;
+    }
+
+    if (cleri__parse_walk(
+            pr,
+            node,
+            keywords->keywords[found],
+            rule,
+            CLERI__EXP_MODE_REQUIRED) == NULL)
+    {
+        cleri__node_free(pr, node);
+        return NULL;
+    }
+
+    parent->len += node->len;
+    if (cleri__children_add(pr, parent, node))
+    {
+         /* error occurred, reverse changes set node to NULL */
+        pr->is_valid = -1;
+        parent->len -= node->len;
+        cleri__node_free(pr, node);
+        node = NULL;
+    }
+    return node;
+}
+
+/*
+ * Update expecting for the first n keywords, except the one found, like each
+ * of them is walked without a match.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int CHOICE_keywords_expecting(
+        cleri_parse_t * pr,
+        cleri_keywords_t * keywords,
+        const char * str,
+        ssize_t found,
+        size_t n)
+{
+    cleri_expecting_t * expecting = pr->expecting;
+    size_t i;
+
+    if (n == 0 || (n == 1 && found == 0))
+    {
+        return 0;
+    }
+
+    /* walking a keyword sets the mode for the position */
+    if (expecting->enabled && cleri__expecting_set_mode(
+            expecting,
+            str,
+            CLERI__EXP_MODE_REQUIRED) == -1)
+    {
+        return -1;
+    }
+
+    /* only the position is used when the keywords are not added to the
+     * lists, which is the same for each keyword */
+    if (!expecting->enabled || str < expecting->str)
+    {
+        return cleri__expecting_update(
+                expecting,
+                keywords->keywords[found == 0 ? 1 : 0],
+                str);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if ((ssize_t) i != found &&
+            cleri__expecting_update(
+                expecting,
+                keywords->keywords[i],
+                str) == -1)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * ctree.c - compact copy of a parse tree using offsets in a single array.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <cleri/ctree.h>
+
+typedef struct
+{
+    cleri_t * cl_obj;
+    uint32_t idx;
+} ctree_slot_t;
+
+typedef struct
+{
+    cleri_ctree_t * ctree;
+    const char * str;
+    size_t objs_sz;         /* allocated objects */
+    size_t mask;            /* number of slots - 1 */
+    ctree_slot_t * slots;
+} ctree_build_t;
+
+static int CTREE_visit(
+        cleri_node_t * node,
+        size_t idx,
+        size_t end,
+        void * data);
+static int CTREE_obj(ctree_build_t * build, cleri_t * cl_obj, uint32_t * idx);
+static int CTREE_grow(ctree_build_t * build);
+
+/*
+ * Returns a compact copy of the parse tree of pr, or NULL in case of an error.
+ *
+ * Each node uses 16 bytes: the offset and length in the parsed string, an
+ * index for the element and the index of the next node after the subtree.
+ * The nodes are stored in pre-order in a single array, so the children of a
+ * node start directly after the node itself. The copy does not depend on pr
+ * so the parse result can be destroyed while the copy is used.
+ *
+ * The parsed string must be smaller than 4 GiB, otherwise NULL is returned.
+ */
+cleri_ctree_t * cleri_ctree_new(cleri_parse_t * pr)
+{
+    ctree_build_t build;
+    size_t n = cleri__node_export_count(pr);
+
+    if (n == 0)
+    {
+        return NULL;
+    }
+
+    build.ctree = (cleri_ctree_t *) malloc(
+            sizeof(cleri_ctree_t) + sizeof(cleri_cnode_t) * n);
+    build.objs_sz = CLERI__CTREE_OBJS_SZ;
+    build.mask = CLERI__CTREE_OBJS_SZ * 2 - 1;
+    build.slots = (ctree_slot_t *) calloc(
+            build.mask + 1,
+            sizeof(ctree_slot_t));
+    build.str = pr->str;
+
+    if (build.ctree == NULL || build.slots == NULL)
+    {
+        free(build.ctree);
+        free(build.slots);
+        return NULL;
+    }
+
+    build.ctree->n = 0;
+    build.ctree->nobjs = 1;
+    build.ctree->nodes = (cleri_cnode_t *) (build.ctree + 1);
+    build.ctree->objs = (cleri_t **) malloc(
+            sizeof(cleri_t *) * build.objs_sz);
+
+    if (build.ctree->objs == NULL)
+    {
+        free(build.slots);
+        free(build.ctree);
+        return NULL;
+    }
+    build.ctree->objs[0] = NULL;
+
+    if (cleri__node_walk(pr->tree, &CTREE_visit, &build))
+    {
+        free(build.slots);
+        cleri_ctree_free(build.ctree);
+        return NULL;
+    }
+
+    free(build.slots);
+    return build.ctree;
+}
+
+/*
+ * Destroy a compact tree. (parsing NULL is allowed)
+ */
+void cleri_ctree_free(cleri_ctree_t * ctree)
+{
+    if (ctree == NULL)
+    {
+        return;
+    }
+    free(ctree->objs);
+    free(ctree);
+}
+
+/*
+ * Append a node to the compact tree before the children and set the end of
+ * the subtree after the children. (see cleri__node_walk())
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int CTREE_visit(
+        cleri_node_t * node,
+        size_t idx,
+        size_t end,
+        void * data)
+{
+    ctree_build_t * build = (ctree_build_t *) data;
+    cleri_cnode_t * cnode = build->ctree->nodes + idx;
+
+    if (end)
+    {
+        cnode->end = (uint32_t) end;
+        return 0;
+    }
+
+    build->ctree->n++;
+    cnode->pos = (uint32_t) (node->str - build->str);
+    cnode->len = (uint32_t) node->len;
+    cnode->obj = 0;
+
+    return (node->cl_obj != NULL &&
+            CTREE_obj(build, node->cl_obj, &cnode->obj)) ? -1 : 0;
+}
+
+/*
+ * Set idx to the index of an object. The object is added to the index when
+ * required.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int CTREE_obj(ctree_build_t * build, cleri_t * cl_obj, uint32_t * idx)
+{
+    cleri_ctree_t * ctree = build->ctree;
+    ctree_slot_t * slot;
+    size_t i = ((uintptr_t) cl_obj >> 4) & build->mask;
+
+    for (;; i = (i + 1) & build->mask)
+    {
+        slot = build->slots + i;
+        if (slot->cl_obj == cl_obj)
+        {
+            *idx = slot->idx;
+            return 0;
+        }
+        if (slot->cl_obj == NULL)
+        {
+            break;
+        }
+    }
+
+    if (ctree->nobjs == build->objs_sz)
+    {
+        cleri_t ** tmp = (cleri_t **) realloc(
+                ctree->objs,
+                sizeof(cleri_t *) * build->objs_sz * 2);
+        if (tmp == NULL)
+        {
+            return -1;
+        }
+        ctree->objs = tmp;
+        build->objs_sz *= 2;
+    }
+
+    slot->cl_obj = cl_obj;
+    slot->idx = *idx = ctree->nobjs++;
+    ctree->objs[slot->idx] = cl_obj;
+
+    /* keep at least half of the slots empty */
+    return (ctree->nobjs * 2 > build->mask) ? CTREE_grow(build) : 0;
+}
+
+/*
+ * Double the number of slots for the object index.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int CTREE_grow(ctree_build_t * build)
+{
+    size_t i, j, mask = build->mask * 2 + 1;
+    ctree_slot_t * slots = (ctree_slot_t *) calloc(
+            mask + 1,
+            sizeof(ctree_slot_t));
+
+    if (slots == NULL)
+    {
+        return -1;
+    }
+
+    for (i = 0; i <= build->mask; i++)
+    {
+        if (build->slots[i].cl_obj == NULL)
+        {
+            continue;
+        }
+        j = ((uintptr_t) build->slots[i].cl_obj >> 4) & mask;
+        while (slots[j].cl_obj != NULL)
+        {
+            j = (j + 1) & mask;
+        }
+        slots[j] = build->slots[i];
+    }
+
+    free(build->slots);
+    build->slots = slots;
+    build->mask = mask;
+    return 0;
+}
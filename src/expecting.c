@@ -14,44 +14,55 @@
 #include <stdlib.h>
 #include <assert.h>
 
-static cleri_exp_modes_t * EXPECTING_modes_new(const char * str);
+static cleri_olist_t * EXPECTING_olist_new(cleri_arena_t * arena);
+static int EXPECTING_olist_append(
+        cleri_arena_t * arena,
+        cleri_olist_t * olist,
+        cleri_t * cl_object);
+static cleri_exp_modes_t * EXPECTING_modes_new(
+        cleri_arena_t * arena,
+        const char * str);
 static void EXPECTING_empty(cleri_expecting_t * expecting);
+static void EXPECTING_olist_free(cleri_arena_t * arena, cleri_olist_t * olist);
 static int EXPECTING_get_mode(cleri_exp_modes_t * modes, const char * str);
 static void EXPECTING_shift_modes(
-        cleri_exp_modes_t ** modes,
+        cleri_expecting_t * expecting,
         const char * str);
-static void EXPECTING_modes_free(cleri_exp_modes_t * modes);
 
 /*
  * Returns NULL in case an error has occurred.
+ * (all memory is allocated from the parse arena)
+ *
+ * When enabled is false, no lists are created and only the position of the
+ * furthest failing element is tracked.
  */
-cleri_expecting_t * cleri__expecting_new(const char * str)
+cleri_expecting_t * cleri__expecting_new(
+        cleri_arena_t * arena,
+        const char * str,
+        bool enabled)
 {
-    cleri_expecting_t * expecting =
-            (cleri_expecting_t *) malloc(sizeof(cleri_expecting_t));
+    cleri_expecting_t * expecting = (cleri_expecting_t *) cleri__arena_alloc(
+            arena,
+            sizeof(cleri_expecting_t));
 
     if (expecting != NULL)
     {
         expecting->str = str;
+        expecting->top = str;
+        expecting->arena = arena;
+        expecting->enabled = enabled;
 
-        if ((expecting->required = cleri__olist_new()) == NULL)
-        {
-            free(expecting);
-            return NULL;
-        }
-
-        if ((expecting->optional = cleri__olist_new()) == NULL)
+        if (!enabled)
         {
-            free(expecting->required);
-            free(expecting);
-            return NULL;
+            expecting->required = NULL;
+            expecting->optional = NULL;
+            expecting->modes = NULL;
         }
-
-        if ((expecting->modes = EXPECTING_modes_new(str)) == NULL)
+        else if (
+                (expecting->required = EXPECTING_olist_new(arena)) == NULL ||
+                (expecting->optional = EXPECTING_olist_new(arena)) == NULL ||
+                (expecting->modes = EXPECTING_modes_new(arena, str)) == NULL)
         {
-            free(expecting->optional);
-            free(expecting->required);
-            free(expecting);
             return NULL;
         }
     }
@@ -69,11 +80,25 @@ int cleri__expecting_update(
 {
     int rc = 0;
 
+    if (str > expecting->top)
+    {
+        expecting->top = str;
+    }
+
+    if (!expecting->enabled)
+    {
+        if (str > expecting->str)
+        {
+            expecting->str = str;
+        }
+        return 0;
+    }
+
     if (str > expecting->str)
     {
         EXPECTING_empty(expecting);
         expecting->str = str;
-        EXPECTING_shift_modes(&(expecting->modes), str);
+        EXPECTING_shift_modes(expecting, str);
     }
 
     if (expecting->str == str)
@@ -81,12 +106,18 @@ int cleri__expecting_update(
         if (EXPECTING_get_mode(expecting->modes, str))
         {
             /* true (1) is required */
-            rc = cleri__olist_append_nref(expecting->required, cl_obj);
+            rc = EXPECTING_olist_append(
+                    expecting->arena,
+                    expecting->required,
+                    cl_obj);
         }
         else
         {
             /* false (0) is optional */
-            rc = cleri__olist_append_nref(expecting->optional, cl_obj);
+            rc = EXPECTING_olist_append(
+                    expecting->arena,
+                    expecting->optional,
+                    cl_obj);
         }
     }
 
@@ -110,7 +141,9 @@ int cleri__expecting_set_mode(
             return 0;
         }
     }
-    current->next = (cleri_exp_modes_t *) malloc(sizeof(cleri_exp_modes_t));
+    current->next = (cleri_exp_modes_t *) cleri__arena_alloc(
+            expecting->arena,
+            sizeof(cleri_exp_modes_t));
 
     if (current->next == NULL)
     {
@@ -124,18 +157,6 @@ int cleri__expecting_set_mode(
     return 0;
 }
 
-/*
- * Destroy expecting object.
- */
-void cleri__expecting_free(cleri_expecting_t * expecting)
-{
-    EXPECTING_empty(expecting);
-    free(expecting->required);
-    free(expecting->optional);
-    EXPECTING_modes_free(expecting->modes);
-    free(expecting);
-}
-
 /*
  * append optional to required and sets optional to NULL
  */
@@ -145,13 +166,19 @@ void cleri__expecting_combine(cleri_expecting_t * expecting)
 
     if (expecting->optional->cl_obj == NULL)
     {
-        free(expecting->optional);
+        cleri__arena_release(
+                expecting->arena,
+                expecting->optional,
+                sizeof(cleri_olist_t));
         expecting->optional = NULL;
     }
 
     if (required->cl_obj == NULL)
     {
-        free(expecting->required);
+        cleri__arena_release(
+                expecting->arena,
+                expecting->required,
+                sizeof(cleri_olist_t));
         expecting->required = expecting->optional;
     }
     else
@@ -165,13 +192,98 @@ void cleri__expecting_combine(cleri_expecting_t * expecting)
     expecting->optional = NULL;
 }
 
+/*
+ * Return the lists and modes to the arena. (parsing NULL is allowed)
+ */
+void cleri__expecting_free(cleri_expecting_t * expecting)
+{
+    cleri_exp_modes_t * next;
+
+    if (expecting == NULL)
+    {
+        return;
+    }
+
+    /* when combined, optional is NULL and part of required */
+    EXPECTING_olist_free(expecting->arena, expecting->required);
+    EXPECTING_olist_free(expecting->arena, expecting->optional);
+
+    while (expecting->modes != NULL)
+    {
+        next = expecting->modes->next;
+        cleri__arena_release(
+                expecting->arena,
+                expecting->modes,
+                sizeof(cleri_exp_modes_t));
+        expecting->modes = next;
+    }
+
+    cleri__arena_release(
+            expecting->arena,
+            expecting,
+            sizeof(cleri_expecting_t));
+}
+
 /*
  * Returns NULL in case an error has occurred.
  */
-static cleri_exp_modes_t * EXPECTING_modes_new(const char * str)
+static cleri_olist_t * EXPECTING_olist_new(cleri_arena_t * arena)
 {
-    cleri_exp_modes_t * modes =
-            (cleri_exp_modes_t *) malloc(sizeof(cleri_exp_modes_t));
+    cleri_olist_t * olist = (cleri_olist_t *) cleri__arena_alloc(
+            arena,
+            sizeof(cleri_olist_t));
+    if (olist != NULL)
+    {
+        olist->cl_obj = NULL;
+        olist->next = NULL;
+    }
+    return olist;
+}
+
+/*
+ * Returns 0 if successful or -1 in case of an error.
+ * Like cleri__olist_append() but the reference counter will not be
+ * incremented and memory is allocated from the arena.
+ */
+static int EXPECTING_olist_append(
+        cleri_arena_t * arena,
+        cleri_olist_t * olist,
+        cleri_t * cl_object)
+{
+    if (olist->cl_obj == NULL)
+    {
+        olist->cl_obj = cl_object;
+        olist->next = NULL;
+        return 0;
+    }
+
+    while (olist->next != NULL)
+    {
+        olist = olist->next;
+    }
+
+    olist->next = EXPECTING_olist_new(arena);
+
+    if (olist->next == NULL)
+    {
+        return -1;
+    }
+
+    olist->next->cl_obj = cl_object;
+
+    return 0;
+}
+
+/*
+ * Returns NULL in case an error has occurred.
+ */
+static cleri_exp_modes_t * EXPECTING_modes_new(
+        cleri_arena_t * arena,
+        const char * str)
+{
+    cleri_exp_modes_t * modes = (cleri_exp_modes_t *) cleri__arena_alloc(
+            arena,
+            sizeof(cleri_exp_modes_t));
     if (modes != NULL)
     {
         modes->mode = CLERI__EXP_MODE_REQUIRED;
@@ -185,34 +297,23 @@ static cleri_exp_modes_t * EXPECTING_modes_new(const char * str)
  * shift from modes
  */
 static void EXPECTING_shift_modes(
-        cleri_exp_modes_t ** modes,
+        cleri_expecting_t * expecting,
         const char * str)
 {
     cleri_exp_modes_t * next;
 
-    while ((*modes)->next != NULL)
+    while (expecting->modes->next != NULL)
     {
-        if ((*modes)->str == str)
+        if (expecting->modes->str == str)
         {
             break;
         }
-        next = (*modes)->next;
-        free(*modes);
-        *modes = next;
-    }
-}
-
-/*
- * Destroy modes.
- */
-static void EXPECTING_modes_free(cleri_exp_modes_t * modes)
-{
-    cleri_exp_modes_t * next;
-    while (modes != NULL)
-    {
-        next = modes->next;
-        free(modes);
-        modes = next;
+        next = expecting->modes->next;
+        cleri__arena_release(
+                expecting->arena,
+                expecting->modes,
+                sizeof(cleri_exp_modes_t));
+        expecting->modes = next;
     }
 }
 
@@ -232,10 +333,44 @@ static int EXPECTING_get_mode(cleri_exp_modes_t * modes, const char * str)
 }
 
 /*
- * Empty both required and optional lists.
+ * Empty both required and optional lists. The first item of both lists is
+ * kept, all other items are returned to the arena.
  */
 static void EXPECTING_empty(cleri_expecting_t * expecting)
 {
-    cleri__olist_empty(expecting->required);
-    cleri__olist_empty(expecting->optional);
+    cleri_olist_t * lists[2] = {expecting->required, expecting->optional};
+    cleri_olist_t * current, * next;
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        current = lists[i]->next;
+        lists[i]->cl_obj = NULL;
+        lists[i]->next = NULL;
+
+        while (current != NULL)
+        {
+            next = current->next;
+            cleri__arena_release(
+                    expecting->arena,
+                    current,
+                    sizeof(cleri_olist_t));
+            current = next;
+        }
+    }
+}
+
+/*
+ * Return all items of a list to the arena. (parsing NULL is allowed)
+ */
+static void EXPECTING_olist_free(cleri_arena_t * arena, cleri_olist_t * olist)
+{
+    cleri_olist_t * next;
+
+    while (olist != NULL)
+    {
+        next = olist->next;
+        cleri__arena_release(arena, olist, sizeof(cleri_olist_t));
+        olist = next;
+    }
 }
@@ -0,0 +1,437 @@
+/*
+ * first.c - bytes which can start a match of an element.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <cleri/first.h>
+#include <cleri/parse.h>
+#include <cleri/expecting.h>
+
+typedef struct
+{
+    void * element;
+    uint32_t idx;
+} first_slot_t;
+
+typedef struct
+{
+    size_t mask;            /* number of slots - 1 */
+    first_slot_t * slots;
+    cleri_first_t * infos;  /* result for each element */
+    cleri_first_t any;      /* all bytes and nullable */
+} first_build_t;
+
+static bool FIRST_update(
+        first_build_t * build,
+        cleri_t * cl_obj,
+        cleri_first_t * info);
+static void FIRST_olist(
+        first_build_t * build,
+        cleri_olist_t * olist,
+        cleri_first_t * res);
+static const cleri_first_t * FIRST_of(
+        first_build_t * build,
+        cleri_t * cl_obj,
+        cleri_first_t * tmp);
+static void FIRST_union(cleri_first_t * res, const cleri_first_t * first);
+static int FIRST_alternatives(
+        first_build_t * build,
+        cleri_olist_t * olist,
+        cleri_first_t ** alternatives);
+
+/*
+ * Set the first bytes for the alternatives of each choice and prio in
+ * elements. Elements must contain each element with other elements within
+ * once, like they are found by cleri_grammar().
+ *
+ * The first bytes of an element depend on the elements within, which may
+ * refer back to the element itself. Therefore each element starts without
+ * bytes and the elements are updated until nothing changes. The result may
+ * contain more bytes than required, for example THIS allows all bytes since
+ * it depends on the prio in which it is used, but never less.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+int cleri__first_prepare(cleri_t ** elements, size_t n)
+{
+    first_build_t build;
+    cleri_choice_t * choice;
+    cleri_prio_t * prio;
+    bool changed;
+    size_t i, j, sz = 1;
+    int rc = 0;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    if (n >= UINT32_MAX)
+    {
+        return -1;
+    }
+
+    /* keep at least half of the slots empty */
+    while (sz < n * 2)
+    {
+        sz *= 2;
+    }
+
+    build.mask = sz - 1;
+    build.slots = (first_slot_t *) calloc(sz, sizeof(first_slot_t));
+    build.infos = (cleri_first_t *) calloc(n, sizeof(cleri_first_t));
+    build.any.nullable = true;
+    memset(build.any.bits, 0xff, sizeof(build.any.bits));
+
+    if (build.slots == NULL || build.infos == NULL)
+    {
+        free(build.slots);
+        free(build.infos);
+        return -1;
+    }
+
+    /* a duplicate shares the element, so the element is used as key */
+    for (i = 0; i < n; i++)
+    {
+        j = ((uintptr_t) elements[i]->via.dummy >> 4) & build.mask;
+        while (build.slots[j].element != NULL)
+        {
+            j = (j + 1) & build.mask;
+        }
+        build.slots[j].element = elements[i]->via.dummy;
+        build.slots[j].idx = (uint32_t) i;
+    }
+
+    do
+    {
+        changed = false;
+        for (i = 0; i < n; i++)
+        {
+            changed |= FIRST_update(&build, elements[i], build.infos + i);
+        }
+    }
+    while (changed);
+
+    for (i = 0; i < n && rc == 0; i++)
+    {
+        switch (elements[i]->tp)
+        {
+        case CLERI_TP_CHOICE:
+            /* a choice with keywords finds the keyword using a hash table */
+            choice = elements[i]->via.choice;
+            if (choice->first == NULL && choice->keywords == NULL)
+            {
+                rc = FIRST_alternatives(&build, choice->olist, &choice->first);
+            }
+            break;
+        case CLERI_TP_PRIO:
+            prio = elements[i]->via.prio;
+            if (prio->first == NULL)
+            {
+                rc = FIRST_alternatives(&build, prio->olist, &prio->first);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    free(build.slots);
+    free(build.infos);
+    return rc;
+}
+
+/*
+ * Returns true when an element with the given first bytes cannot match at
+ * str, in which case the element does not need to be walked. Expecting is
+ * updated like the element is walked without a match.
+ *
+ * The expected elements are only collected at the furthest position, so with
+ * expecting enabled the element is only skipped before that position. This
+ * way the expected elements are exactly the same.
+ *
+ * In case of an error pr->is_valid is set to -1.
+ */
+bool cleri__first_skip(
+        cleri_parse_t * pr,
+        cleri_first_t * first,
+        cleri_t * cl_obj,
+        const char * str)
+{
+    cleri_expecting_t * expecting = pr->expecting;
+
+    if (first->nullable ||
+        (
+            cleri__parse_remaining(pr, str) &&
+            CLERI__FIRST_HAS(first->bits, (unsigned char) *str)
+        ) ||
+        (expecting->enabled && str >= expecting->str))
+    {
+        return false;
+    }
+
+    /* only the byte at str, or the end of the string, is examined */
+    cleri__parse_examined(pr, str, 1);
+
+    /* walking the element sets the mode for the position */
+    if ((
+            expecting->enabled &&
+            cleri__expecting_set_mode(
+                expecting,
+                str,
+                CLERI__EXP_MODE_REQUIRED) == -1
+        ) ||
+        cleri__expecting_update(expecting, cl_obj, str) == -1)
+    {
+        pr->is_valid = -1;
+    }
+    return true;
+}
+
+/*
+ * Add the first bytes of an element, using the current result for the
+ * elements within, to info.
+ *
+ * Returns true when info is changed.
+ */
+static bool FIRST_update(
+        first_build_t * build,
+        cleri_t * cl_obj,
+        cleri_first_t * info)
+{
+    cleri_first_t res, tmp;
+    const cleri_first_t * first;
+    cleri_olist_t * olist;
+    bool changed = false;
+    size_t i;
+
+    memset(&res, 0, sizeof(res));
+
+    switch (cl_obj->tp)
+    {
+    case CLERI_TP_SEQUENCE:
+        /* the bytes of each element until an element cannot be empty */
+        res.nullable = true;
+        for (olist = cl_obj->via.sequence->olist;
+             olist != NULL && olist->cl_obj != NULL && res.nullable;
+             olist = olist->next)
+        {
+            first = FIRST_of(build, olist->cl_obj, &tmp);
+            FIRST_union(&res, first);
+            res.nullable = first->nullable;
+        }
+        break;
+    case CLERI_TP_OPTIONAL:
+        FIRST_union(&res, FIRST_of(build, cl_obj->via.optional->cl_obj, &tmp));
+        res.nullable = true;
+        break;
+    case CLERI_TP_CHOICE:
+        FIRST_olist(build, cl_obj->via.choice->olist, &res);
+        break;
+    case CLERI_TP_PRIO:
+        FIRST_olist(build, cl_obj->via.prio->olist, &res);
+        break;
+    case CLERI_TP_LIST:
+        /* the delimiter may be first when the element can be empty */
+        first = FIRST_of(build, cl_obj->via.list->cl_obj, &tmp);
+        FIRST_union(&res, first);
+        res.nullable = cl_obj->via.list->min == 0 || first->nullable;
+        if (first->nullable)
+        {
+            FIRST_union(
+                    &res,
+                    FIRST_of(build, cl_obj->via.list->delimiter, &tmp));
+        }
+        break;
+    case CLERI_TP_REPEAT:
+        first = FIRST_of(build, cl_obj->via.repeat->cl_obj, &tmp);
+        FIRST_union(&res, first);
+        res.nullable = cl_obj->via.repeat->min == 0 || first->nullable;
+        break;
+    case CLERI_TP_RULE:
+        res = *FIRST_of(build, cl_obj->via.rule->cl_obj, &tmp);
+        break;
+    default:
+        return false;
+    }
+
+    for (i = 0; i < sizeof(res.bits); i++)
+    {
+        if (res.bits[i] & ~info->bits[i])
+        {
+            info->bits[i] |= res.bits[i];
+            changed = true;
+        }
+    }
+
+    if (res.nullable && !info->nullable)
+    {
+        info->nullable = true;
+        changed = true;
+    }
+
+    return changed;
+}
+
+/*
+ * Set res to the first bytes of any element in olist.
+ */
+static void FIRST_olist(
+        first_build_t * build,
+        cleri_olist_t * olist,
+        cleri_first_t * res)
+{
+    const cleri_first_t * first;
+    cleri_first_t tmp;
+
+    for (; olist != NULL && olist->cl_obj != NULL; olist = olist->next)
+    {
+        first = FIRST_of(build, olist->cl_obj, &tmp);
+        FIRST_union(res, first);
+        res->nullable = res->nullable || first->nullable;
+    }
+}
+
+/*
+ * Returns the first bytes of an element. The result is written to tmp when
+ * the element has no other elements within.
+ */
+static const cleri_first_t * FIRST_of(
+        first_build_t * build,
+        cleri_t * cl_obj,
+        cleri_first_t * tmp)
+{
+    cleri_keyword_t * keyword;
+    size_t i;
+    int c;
+
+    if (cl_obj == NULL)
+    {
+        return &build->any;
+    }
+
+    memset(tmp, 0, sizeof(cleri_first_t));
+
+    switch (cl_obj->tp)
+    {
+    case CLERI_TP_SEQUENCE:
+    case CLERI_TP_OPTIONAL:
+    case CLERI_TP_CHOICE:
+    case CLERI_TP_LIST:
+    case CLERI_TP_REPEAT:
+    case CLERI_TP_PRIO:
+    case CLERI_TP_RULE:
+        for (i = ((uintptr_t) cl_obj->via.dummy >> 4) & build->mask;
+             build->slots[i].element != NULL;
+             i = (i + 1) & build->mask)
+        {
+            if (build->slots[i].element == cl_obj->via.dummy)
+            {
+                return build->infos + build->slots[i].idx;
+            }
+        }
+        return &build->any;
+    case CLERI_TP_KEYWORD:
+        keyword = cl_obj->via.keyword;
+        if (keyword->len == 0)
+        {
+            tmp->nullable = true;
+            return tmp;
+        }
+        c = (unsigned char) keyword->keyword[0];
+        CLERI__FIRST_SET(tmp->bits, c);
+        if (keyword->ign_case)
+        {
+            for (i = 0; i < 256; i++)
+            {
+                if (tolower((int) i) == tolower(c))
+                {
+                    CLERI__FIRST_SET(tmp->bits, i);
+                }
+            }
+        }
+        return tmp;
+    case CLERI_TP_TOKEN:
+        if (cl_obj->via.token->len == 0)
+        {
+            tmp->nullable = true;
+            return tmp;
+        }
+        c = (unsigned char) cl_obj->via.token->token[0];
+        CLERI__FIRST_SET(tmp->bits, c);
+        return tmp;
+    case CLERI_TP_TOKENS:
+        for (i = 0; i < 256; i++)
+        {
+            if (cl_obj->via.tokens->first[i] != NULL)
+            {
+                CLERI__FIRST_SET(tmp->bits, i);
+            }
+        }
+        return tmp;
+    case CLERI_TP_REGEX:
+        memcpy(tmp->bits, cl_obj->via.regex->first, sizeof(tmp->bits));
+        tmp->nullable = cl_obj->via.regex->minlength == 0;
+        return tmp;
+    default:
+        /* THIS depends on the prio in which it is used, and a reference
+         * which is not set may become any element */
+        return &build->any;
+    }
+}
+
+/*
+ * Add the bytes of first to res.
+ */
+static void FIRST_union(cleri_first_t * res, const cleri_first_t * first)
+{
+    size_t i;
+    for (i = 0; i < sizeof(res->bits); i++)
+    {
+        res->bits[i] |= first->bits[i];
+    }
+}
+
+/*
+ * Set alternatives to an array with the first bytes for each element in
+ * olist.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int FIRST_alternatives(
+        first_build_t * build,
+        cleri_olist_t * olist,
+        cleri_first_t ** alternatives)
+{
+    cleri_olist_t * current;
+    cleri_first_t tmp;
+    size_t n = 0;
+
+    for (current = olist;
+         current != NULL && current->cl_obj != NULL;
+         current = current->next)
+    {
+        ++n;
+    }
+
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    *alternatives = (cleri_first_t *) malloc(sizeof(cleri_first_t) * n);
+    if (*alternatives == NULL)
+    {
+        return -1;
+    }
+
+    for (n = 0; olist != NULL && olist->cl_obj != NULL; olist = olist->next)
+    {
+        (*alternatives)[n++] = *FIRST_of(build, olist->cl_obj, &tmp);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * flat.c - parse tree as an array of fixed size records without pointers.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#include <stdlib.h>
+#include <cleri/flat.h>
+
+typedef struct
+{
+    cleri_flat_t * flat;
+    const char * str;
+    size_t n;               /* written records for CLERI_FLAT_POSTORDER */
+    int order;
+} flat_build_t;
+
+static int FLAT_visit(
+        cleri_node_t * node,
+        size_t idx,
+        size_t end,
+        void * data);
+
+/*
+ * Returns the number of records and sets buf to a new array with a record
+ * for each node in the parse tree, or returns 0 in case of an error. (the
+ * root node is always included so a successful call never returns 0)
+ *
+ * Records contain no pointers, only offsets in the parsed string, so the
+ * array can be written to disk or shared with another process as it is. With
+ * CLERI_FLAT_PREORDER the children of a node follow the node, with
+ * CLERI_FLAT_POSTORDER the children are before the node. The number of
+ * children in each record is sufficient for restoring the tree.
+ *
+ * The parsed string must be smaller than 4 GiB, otherwise 0 is returned. The
+ * array must be destroyed using free().
+ */
+size_t cleri_parse_flatten(
+        cleri_parse_t * pr,
+        cleri_flat_t ** buf,
+        int order)
+{
+    flat_build_t build;
+    size_t n = cleri__node_export_count(pr);
+
+    *buf = NULL;
+    if (n == 0 || n > SIZE_MAX / sizeof(cleri_flat_t))
+    {
+        return 0;
+    }
+
+    *buf = (cleri_flat_t *) malloc(sizeof(cleri_flat_t) * n);
+    if (*buf == NULL)
+    {
+        return 0;
+    }
+
+    build.flat = *buf;
+    build.str = pr->str;
+    build.n = 0;
+    build.order = order;
+
+    (void) cleri__node_walk(pr->tree, &FLAT_visit, &build);
+    return n;
+}
+
+/*
+ * Write the record for a node, before the children for CLERI_FLAT_PREORDER
+ * and after the children otherwise. (see cleri__node_walk())
+ */
+static int FLAT_visit(
+        cleri_node_t * node,
+        size_t idx,
+        size_t end,
+        void * data)
+{
+    flat_build_t * build = (flat_build_t *) data;
+    cleri_flat_t * rec;
+
+    if (build->order == CLERI_FLAT_PREORDER)
+    {
+        if (end)
+        {
+            return 0;
+        }
+        rec = build->flat + idx;
+    }
+    else
+    {
+        if (!end)
+        {
+            return 0;
+        }
+        rec = build->flat + build->n++;
+    }
+
+    rec->gid = (node->cl_obj == NULL) ? 0 : node->cl_obj->gid;
+    rec->tp = (node->cl_obj == NULL) ?
+            CLERI_FLAT_TP_ROOT : (uint32_t) node->cl_obj->tp;
+    rec->pos = (uint32_t) (node->str - build->str);
+    rec->len = (uint32_t) node->len;
+    rec->nchildren = (node->children == NULL) ? 0 : node->nchildren;
+
+    return 0;
+}
@@ -12,14 +12,41 @@
 #define PCRE2_CODE_UNIT_WIDTH 8
 
 #include <cleri/grammar.h>
+#include <cleri/first.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <pcre2.h>
+#include <string.h>
 #include <assert.h>
 
+typedef struct
+{
+    size_t n;               /* number of elements */
+    size_t mask;            /* number of slots - 1 */
+    void ** slots;
+    cleri_t ** elements;    /* elements in the order they are seen */
+} grammar_seen_t;
+
+static int GRAMMAR_prepare(cleri_t * start);
+static int GRAMMAR_walk(grammar_seen_t * seen, cleri_t * cl_obj);
+static int GRAMMAR_walk_olist(grammar_seen_t * seen, cleri_olist_t * olist);
+static int GRAMMAR_seen(grammar_seen_t * seen, cleri_t * cl_obj);
+static void GRAMMAR_kw_scan(cleri_grammar_t * grammar, const char * re_kw);
+static const char * GRAMMAR_kw_atom(const char * pt);
+static const char * GRAMMAR_kw_quantifier(const char * pt, char q);
+static int GRAMMAR_kw_probe(
+        unsigned char * kw_table,
+        const char * atom,
+        size_t n,
+        unsigned char bits);
+
 /*
  * Returns a grammar object or NULL in case of an error.
  *
+ * The grammar is not changed while parsing so a single grammar can be used
+ * to parse strings from multiple threads at the same time.
+ *
  * Warning: this function could write to stderr in case the re_keywords could
  * not be compiled.
  */
@@ -66,13 +93,16 @@ cleri_grammar_t * cleri_grammar(cleri_t * start, const char * re_keywords)
         return NULL;
     }
 
-    grammar->match_data = \
-        pcre2_match_data_create_from_pattern(grammar->re_keywords, NULL);
+    /* use JIT when available, otherwise the interpreter is used */
+    (void) pcre2_jit_compile(grammar->re_keywords, PCRE2_JIT_COMPLETE);
+    grammar->jit = true;
+    grammar->stack_limit = SIZE_MAX;
+
+    GRAMMAR_kw_scan(grammar, re_kw);
 
-    if (grammar->match_data == NULL)
+    if (GRAMMAR_prepare(start))
     {
         pcre2_code_free(grammar->re_keywords);
-        fprintf(stderr, "error: cannot create matsch data\n");
         free(grammar);
         return NULL;
     }
@@ -84,10 +114,408 @@ cleri_grammar_t * cleri_grammar(cleri_t * start, const char * re_keywords)
     return grammar;
 }
 
+/*
+ * Enable or disable the use of JIT compiled regular expressions when parsing
+ * with the grammar. JIT is enabled by default, but is only used when PCRE2 is
+ * built with JIT support. Do not call this function while parsing.
+ */
+void cleri_grammar_set_jit(cleri_grammar_t * grammar, bool jit)
+{
+    grammar->jit = jit;
+}
+
+/*
+ * Set the maximum number of bytes of stack a parse with the grammar may use,
+ * see cleri_parser_set_stack_limit(). There is no limit by default, use 0 to
+ * remove the limit again. Do not call this function while parsing.
+ */
+void cleri_grammar_set_stack_limit(cleri_grammar_t * grammar, size_t size)
+{
+    grammar->stack_limit = (size) ? size : SIZE_MAX;
+}
+
 void cleri_grammar_free(cleri_grammar_t * grammar)
 {
-    pcre2_match_data_free(grammar->match_data);
     pcre2_code_free(grammar->re_keywords);
     cleri_free(grammar->start);
     free(grammar);
 }
+
+/*
+ * Prepare all elements of a grammar for parsing. Each element is visited
+ * once, also when an element is used more than once or refers to itself.
+ *
+ * A choice with only keyword elements gets a hash table, so the matching
+ * keyword is found without trying each keyword. Each choice and prio gets the
+ * bytes which can start a match for the alternatives, so alternatives which
+ * cannot match are not tried.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int GRAMMAR_prepare(cleri_t * start)
+{
+    int rc;
+    grammar_seen_t seen = {
+            .n=0,
+            .mask=CLERI__GRAMMAR_SEEN_SZ - 1,
+            .slots=(void **) calloc(CLERI__GRAMMAR_SEEN_SZ, sizeof(void *)),
+            .elements=(cleri_t **) malloc(
+                    sizeof(cleri_t *) * CLERI__GRAMMAR_SEEN_SZ / 2)};
+
+    if (seen.slots == NULL || seen.elements == NULL)
+    {
+        free(seen.slots);
+        free(seen.elements);
+        return -1;
+    }
+
+    rc = (
+        GRAMMAR_walk(&seen, start) ||
+        cleri__first_prepare(seen.elements, seen.n)
+    ) ? -1 : 0;
+
+    free(seen.slots);
+    free(seen.elements);
+    return rc;
+}
+
+/*
+ * Prepare an element and all elements within.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int GRAMMAR_walk(grammar_seen_t * seen, cleri_t * cl_obj)
+{
+    int rc;
+
+    switch (cl_obj->tp)
+    {
+    case CLERI_TP_SEQUENCE:
+    case CLERI_TP_OPTIONAL:
+    case CLERI_TP_CHOICE:
+    case CLERI_TP_LIST:
+    case CLERI_TP_REPEAT:
+    case CLERI_TP_PRIO:
+    case CLERI_TP_RULE:
+        break;
+    default:
+        /* no elements within, or a reference which is not set */
+        return 0;
+    }
+
+    if ((rc = GRAMMAR_seen(seen, cl_obj)) != 0)
+    {
+        return (rc < 0) ? -1 : 0;
+    }
+
+    switch (cl_obj->tp)
+    {
+    case CLERI_TP_SEQUENCE:
+        return GRAMMAR_walk_olist(seen, cl_obj->via.sequence->olist);
+    case CLERI_TP_OPTIONAL:
+        return GRAMMAR_walk(seen, cl_obj->via.optional->cl_obj);
+    case CLERI_TP_CHOICE:
+        /* keywords is NULL when not all elements are keywords, in which
+         * case each element is tried like before */
+        if (cl_obj->via.choice->keywords == NULL)
+        {
+            cl_obj->via.choice->keywords = cleri__keywords_new(
+                    cl_obj->via.choice->olist);
+        }
+        return GRAMMAR_walk_olist(seen, cl_obj->via.choice->olist);
+    case CLERI_TP_LIST:
+        return (
+            GRAMMAR_walk(seen, cl_obj->via.list->cl_obj) ||
+            GRAMMAR_walk(seen, cl_obj->via.list->delimiter)
+        ) ? -1 : 0;
+    case CLERI_TP_REPEAT:
+        return GRAMMAR_walk(seen, cl_obj->via.repeat->cl_obj);
+    case CLERI_TP_PRIO:
+        return GRAMMAR_walk_olist(seen, cl_obj->via.prio->olist);
+    case CLERI_TP_RULE:
+        return GRAMMAR_walk(seen, cl_obj->via.rule->cl_obj);
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Prepare the elements in a list.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int GRAMMAR_walk_olist(grammar_seen_t * seen, cleri_olist_t * olist)
+{
+    for (; olist != NULL && olist->cl_obj != NULL; olist = olist->next)
+    {
+        if (GRAMMAR_walk(seen, olist->cl_obj))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Returns 1 when the element is seen before, 0 when the element is added to
+ * the seen elements, or -1 in case of an error.
+ */
+static int GRAMMAR_seen(grammar_seen_t * seen, cleri_t * cl_obj)
+{
+    size_t i, j, mask;
+    void ** slots;
+    cleri_t ** elements;
+
+    /* a duplicate shares the element, so the element is used as key */
+    void * element = cl_obj->via.dummy;
+
+    for (i = ((uintptr_t) element >> 4) & seen->mask;
+         seen->slots[i] != NULL;
+         i = (i + 1) & seen->mask)
+    {
+        if (seen->slots[i] == element)
+        {
+            return 1;
+        }
+    }
+
+    seen->slots[i] = element;
+    seen->elements[seen->n] = cl_obj;
+
+    /* keep at least half of the slots empty */
+    if (++seen->n * 2 <= seen->mask)
+    {
+        return 0;
+    }
+
+    /* the elements fit as long as half of the slots are empty */
+    mask = seen->mask * 2 + 1;
+    slots = (void **) calloc(mask + 1, sizeof(void *));
+    elements = (cleri_t **) realloc(
+            seen->elements,
+            sizeof(cleri_t *) * (mask + 1) / 2);
+    if (slots == NULL || elements == NULL)
+    {
+        free(slots);
+        if (elements != NULL)
+        {
+            seen->elements = elements;
+        }
+        return -1;
+    }
+    seen->elements = elements;
+
+    for (i = 0; i <= seen->mask; i++)
+    {
+        if (seen->slots[i] == NULL)
+        {
+            continue;
+        }
+        j = ((uintptr_t) seen->slots[i] >> 4) & mask;
+        while (slots[j] != NULL)
+        {
+            j = (j + 1) & mask;
+        }
+        slots[j] = seen->slots[i];
+    }
+
+    free(seen->slots);
+    seen->slots = slots;
+    seen->mask = mask;
+    return 0;
+}
+
+/*
+ * Simple keyword patterns, one character class repeated, are matched using a
+ * table instead of the regular expression. This is used for the default
+ * pattern `^\w+` and patterns like `^[a-z_]+` or `^[a-zA-Z_][a-zA-Z0-9_]*`.
+ *
+ * The pattern is only split in atoms here; which characters an atom matches
+ * is asked to PCRE2 itself, so the table always agrees with the regular
+ * expression. When the pattern has another form, grammar->kw_scan is false
+ * and the regular expression is used.
+ */
+static void GRAMMAR_kw_scan(cleri_grammar_t * grammar, const char * re_kw)
+{
+    const char * first = re_kw + 1;     /* skip ^ */
+    const char * next;
+    const char * end;
+
+    memset(grammar->kw_table, 0, sizeof(grammar->kw_table));
+    grammar->kw_scan = false;
+
+    if ((next = GRAMMAR_kw_atom(first)) == NULL)
+    {
+        return;
+    }
+
+    if ((end = GRAMMAR_kw_quantifier(next, '+')) != NULL && *end == '\0')
+    {
+        /* form: ^A+ */
+        grammar->kw_scan = GRAMMAR_kw_probe(
+                grammar->kw_table,
+                first,
+                next - first,
+                CLERI__KW_FIRST|CLERI__KW_NEXT) == 0;
+        return;
+    }
+
+    if (    (end = GRAMMAR_kw_atom(next)) != NULL &&
+            (end = GRAMMAR_kw_quantifier(end, '*')) != NULL &&
+            *end == '\0')
+    {
+        /* form: ^AB* */
+        grammar->kw_scan =
+            GRAMMAR_kw_probe(
+                grammar->kw_table,
+                first,
+                next - first,
+                CLERI__KW_FIRST) == 0 &&
+            GRAMMAR_kw_probe(
+                grammar->kw_table,
+                next,
+                GRAMMAR_kw_atom(next) - next,
+                CLERI__KW_NEXT) == 0;
+    }
+}
+
+/*
+ * Returns the end of a single character atom starting at pt or NULL when pt
+ * does not start with such an atom. Supported are character classes, escapes
+ * for a character type like \w or \d, and escaped punctuation.
+ */
+static const char * GRAMMAR_kw_atom(const char * pt)
+{
+    if (*pt == '\\')
+    {
+        pt++;
+        return (*pt != '\0' && (
+                strchr("wWdDsShHvV", *pt) != NULL ||
+                strchr(".-_+*?^$|()[]{}\\/", *pt) != NULL)) ? pt + 1 : NULL;
+    }
+
+    if (*pt != '[')
+    {
+        return NULL;
+    }
+
+    pt++;
+    if (*pt == '^')
+    {
+        pt++;
+    }
+    if (*pt == ']')
+    {
+        /* a ] as first character is part of the class */
+        pt++;
+    }
+
+    for (; *pt != ']'; pt++)
+    {
+        switch (*pt)
+        {
+        case '\0':
+            return NULL;
+        case '\\':
+            /* quoting and other multi character escapes are not supported */
+            pt++;
+            if (*pt == '\0' || strchr("QEx0123456789opPcNgk", *pt) != NULL)
+            {
+                return NULL;
+            }
+            break;
+        case '[':
+            if (pt[1] == ':')
+            {
+                /* posix class, for example [:alpha:] */
+                pt = strstr(pt + 2, ":]");
+                if (pt == NULL)
+                {
+                    return NULL;
+                }
+                pt++;
+            }
+            break;
+        }
+    }
+    return pt + 1;
+}
+
+/*
+ * Returns the end of quantifier q at pt, which may be possessive, or NULL if
+ * pt does not start with q. A greedy and possessive quantifier give the same
+ * result here since nothing follows.
+ */
+static const char * GRAMMAR_kw_quantifier(const char * pt, char q)
+{
+    if (*pt != q)
+    {
+        return NULL;
+    }
+    pt++;
+    return (*pt == '+') ? pt + 1 : pt;
+}
+
+/*
+ * Set bits in kw_table for each character matched by an atom with length n.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int GRAMMAR_kw_probe(
+        unsigned char * kw_table,
+        const char * atom,
+        size_t n,
+        unsigned char bits)
+{
+    int pcre_error_num;
+    PCRE2_SIZE pcre_error_offset;
+    pcre2_code * re;
+    pcre2_match_data * match_data;
+    unsigned char c[1];
+    char * pattern = (char *) malloc(n + 2);
+    int i;
+
+    if (pattern == NULL)
+    {
+        return -1;
+    }
+
+    pattern[0] = '^';
+    memcpy(pattern + 1, atom, n);
+    pattern[n + 1] = '\0';
+
+    re = pcre2_compile(
+            (PCRE2_SPTR8) pattern,
+            PCRE2_ZERO_TERMINATED,
+            0,
+            &pcre_error_num,
+            &pcre_error_offset,
+            NULL);
+    free(pattern);
+
+    if (re == NULL)
+    {
+        return -1;
+    }
+
+    match_data = pcre2_match_data_create_from_pattern(re, NULL);
+    if (match_data == NULL)
+    {
+        pcre2_code_free(re);
+        return -1;
+    }
+
+    for (i = 0; i < 256; i++)
+    {
+        c[0] = (unsigned char) i;
+        if (pcre2_match(re, c, 1, 0, 0, match_data, NULL) >= 0 &&
+            pcre2_get_ovector_pointer(match_data)[1] == 1)
+        {
+            kw_table[i] |= bits;
+        }
+    }
+
+    pcre2_match_data_free(match_data);
+    pcre2_code_free(re);
+    return 0;
+}
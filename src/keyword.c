@@ -89,10 +89,10 @@ static cleri_node_t * KEYWORD_parse(
            )
        ))
     {
-        if ((node = cleri__node_new(cl_obj, str, match_len)) != NULL)
+        if ((node = cleri__node_new(pr, cl_obj, str, match_len)) != NULL)
         {
             parent->len += node->len;
-            cleri__children_add(parent->children, node);
+            cleri__children_add(pr, parent, node);
         }
     }
     else
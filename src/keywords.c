@@ -0,0 +1,189 @@
+/*
+ * keywords.c - choice between keywords using a hash table.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ */
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <cleri/keywords.h>
+
+static uint32_t KEYWORDS_hash(const char * str, size_t len);
+
+/*
+ * Returns a choice element for the given keyword elements or NULL in case of
+ * an error. Each argument must be a keyword element.
+ *
+ * The result is a normal choice element, so the tree contains the matched
+ * keyword just like a choice. The keyword is found using a hash table on the
+ * word at the position instead of trying each keyword, which makes a choice
+ * between many keywords as fast as a choice between a few.
+ *
+ * Note that cleri_grammar() uses the same hash table for each choice with
+ * only keyword elements, this function is not required to get the benefit.
+ */
+cleri_t * cleri_keywords(uint32_t gid, size_t len, ...)
+{
+    va_list ap;
+    cleri_t * cl_obj;
+    cleri_t * cl_object = cleri_choice(gid, 0, 0);
+
+    if (cl_object == NULL)
+    {
+        return NULL;
+    }
+
+    va_start(ap, len);
+    while(len--)
+    {
+        cl_obj = va_arg(ap, cleri_t *);
+        if (cl_obj == NULL ||
+            cl_obj->tp != CLERI_TP_KEYWORD ||
+            cleri__olist_append(cl_object->via.choice->olist, cl_obj))
+        {
+            cleri__olist_cancel(cl_object->via.choice->olist);
+            cleri_free(cl_object);
+            va_end(ap);
+            return NULL;
+        }
+    }
+    va_end(ap);
+
+    cl_object->via.choice->keywords = cleri__keywords_new(
+            cl_object->via.choice->olist);
+
+    if (cl_object->via.choice->keywords == NULL)
+    {
+        cleri_free(cl_object);
+        return NULL;
+    }
+
+    return cl_object;
+}
+
+/*
+ * Returns a hash table for the elements in olist, or NULL when not all
+ * elements are keywords (with at least one character) or in case of an
+ * error.
+ */
+cleri_keywords_t * cleri__keywords_new(cleri_olist_t * olist)
+{
+    cleri_keywords_t * keywords;
+    cleri_keyword_t * keyword;
+    cleri_olist_t * current;
+    size_t i, sz = 1, n = 0;
+
+    for (current = olist; current != NULL; current = current->next)
+    {
+        if (current->cl_obj == NULL ||
+            current->cl_obj->tp != CLERI_TP_KEYWORD ||
+            current->cl_obj->via.keyword->len == 0)
+        {
+            return NULL;
+        }
+        ++n;
+    }
+
+    if (n >= UINT32_MAX)
+    {
+        return NULL;
+    }
+
+    /* keep at least half of the slots empty */
+    while (sz < n * 2)
+    {
+        sz *= 2;
+    }
+
+    keywords = (cleri_keywords_t *) malloc(
+            sizeof(cleri_keywords_t) +
+            sizeof(cleri_t *) * n +
+            sizeof(uint32_t) * sz);
+    if (keywords == NULL)
+    {
+        return NULL;
+    }
+
+    keywords->n = n;
+    keywords->mask = sz - 1;
+    keywords->keywords = (cleri_t **) (keywords + 1);
+    keywords->slots = (uint32_t *) (keywords->keywords + n);
+    memset(keywords->slots, 0, sizeof(uint32_t) * sz);
+
+    for (n = 0, current = olist; current != NULL; current = current->next, n++)
+    {
+        keyword = current->cl_obj->via.keyword;
+        i = KEYWORDS_hash(keyword->keyword, keyword->len) & keywords->mask;
+        while (keywords->slots[i])
+        {
+            i = (i + 1) & keywords->mask;
+        }
+        keywords->keywords[n] = current->cl_obj;
+        keywords->slots[i] = (uint32_t) n + 1;
+    }
+
+    return keywords;
+}
+
+/*
+ * Returns the index of the first keyword which matches the word str with
+ * length len, or -1 when no keyword matches.
+ *
+ * The hash ignores case so case sensitive and case insensitive keywords can
+ * be found using the same table. All slots are compared until an empty slot
+ * is found, so the first keyword in the choice order is returned when more
+ * keywords match.
+ */
+ssize_t cleri__keywords_find(
+        cleri_keywords_t * keywords,
+        const char * str,
+        size_t len)
+{
+    cleri_keyword_t * keyword;
+    ssize_t found = -1;
+    uint32_t idx;
+    size_t i = KEYWORDS_hash(str, len) & keywords->mask;
+
+    for (; (idx = keywords->slots[i]) != 0; i = (i + 1) & keywords->mask)
+    {
+        keyword = keywords->keywords[--idx]->via.keyword;
+        if (keyword->len == len &&
+            (found == -1 || (ssize_t) idx < found) &&
+            (
+                strncmp(keyword->keyword, str, len) == 0 ||
+                (
+                    keyword->ign_case &&
+                    strncasecmp(keyword->keyword, str, len) == 0
+                )
+            ))
+        {
+            found = (ssize_t) idx;
+        }
+    }
+    return found;
+}
+
+/*
+ * Destroy a keywords hash table. (parsing NULL is allowed)
+ */
+void cleri__keywords_free(cleri_keywords_t * keywords)
+{
+    free(keywords);
+}
+
+/*
+ * Returns a case insensitive FNV-1a hash for a word.
+ */
+static uint32_t KEYWORDS_hash(const char * str, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    while (len--)
+    {
+        hash ^= (uint32_t) tolower((unsigned char) *str++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
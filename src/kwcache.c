@@ -7,6 +7,7 @@
  *
  * changes
  *  - initial version, 08-03-2016
+ *  - hash table by position, 17-10-2026
  *
  */
 #define PCRE2_CODE_UNIT_WIDTH 8
@@ -15,109 +16,255 @@
 #include <pcre2.h>
 #include <string.h>
 #include <cleri/kwcache.h>
+#include <cleri/regex.h>
 
 static void KWCACHE_kw_match(
-        cleri_kwcache_t * kwcache,
+        cleri_kwcache_entry_t * entry,
         cleri_parse_t * pr,
         const char * str);
+static void KWCACHE_kw_scan(
+        cleri_kwcache_entry_t * entry,
+        cleri_parse_t * pr,
+        const char * str);
+static cleri_kwcache_entry_t * KWCACHE_slot(
+        cleri_parse_t * pr,
+        cleri_kwcache_entry_t * entries,
+        size_t mask,
+        const char * str);
+static int KWCACHE_grow(cleri_parse_t * pr, cleri_kwcache_t * kwcache);
 
 /*
  * Returns NULL in case an error has occurred.
+ * (the cache is allocated from the parse arena)
  */
-cleri_kwcache_t * cleri__kwcache_new(void)
+cleri_kwcache_t * cleri__kwcache_new(cleri_parse_t * pr)
 {
     cleri_kwcache_t * kwcache;
-    kwcache = (cleri_kwcache_t *) malloc(sizeof(cleri_kwcache_t));
+    kwcache = (cleri_kwcache_t *) cleri__arena_alloc(
+            pr->arena,
+            sizeof(cleri_kwcache_t));
     if (kwcache != NULL)
     {
-        kwcache->len = 0;
-        kwcache->str = NULL;
-        kwcache->next = NULL;
+        kwcache->hits = 0;
+        kwcache->misses = 0;
+        kwcache->n = 0;
+        kwcache->mask = CLERI__KWCACHE_INITIAL_SZ - 1;
+        kwcache->entries = (cleri_kwcache_entry_t *) cleri__arena_alloc(
+                pr->arena,
+                sizeof(cleri_kwcache_entry_t) * CLERI__KWCACHE_INITIAL_SZ);
+        if (kwcache->entries == NULL)
+        {
+            return NULL;
+        }
+        memset(
+            kwcache->entries,
+            0,
+            sizeof(cleri_kwcache_entry_t) * CLERI__KWCACHE_INITIAL_SZ);
     }
     return kwcache;
 }
 
+/*
+ * Return the cache to the arena of pr. (parsing NULL is allowed)
+ */
+void cleri__kwcache_free(cleri_parse_t * pr, cleri_kwcache_t * kwcache)
+{
+    if (kwcache == NULL)
+    {
+        return;
+    }
+    cleri__arena_release(
+            pr->arena,
+            kwcache->entries,
+            sizeof(cleri_kwcache_entry_t) * (kwcache->mask + 1));
+    cleri__arena_release(pr->arena, kwcache, sizeof(cleri_kwcache_t));
+}
+
 /*
  * Returns 0 when no kw_match is found, -1 when an error has occurred, or the
- * new kwcache->len value.
+ * length of the keyword match at str.
+ *
+ * Results are stored in a hash table by position so each position is only
+ * matched once.
  */
 ssize_t cleri__kwcache_match(
         cleri_parse_t * pr,
         const char * str)
 {
     cleri_kwcache_t * kwcache = pr->kwcache;
-    if (kwcache->str != NULL)
+    cleri_kwcache_entry_t * entry = KWCACHE_slot(
+            pr,
+            kwcache->entries,
+            kwcache->mask,
+            str);
+
+    if (entry->str == NULL)
     {
-        while (1)
+        /* keep the load factor below 75% */
+        if ((kwcache->n + 1) * 4 > (kwcache->mask + 1) * 3)
         {
-            if (str == kwcache->str)
+            if (KWCACHE_grow(pr, kwcache))
             {
-                return kwcache->len;
+                return -1;
             }
+            entry = KWCACHE_slot(
+                    pr,
+                    kwcache->entries,
+                    kwcache->mask,
+                    str);
+        }
 
-            if (kwcache->next == NULL)
-            {
-                break;
-            }
-            kwcache = kwcache->next;
+        kwcache->n++;
+        kwcache->misses++;
+
+        entry->str = str;
+        entry->len = 0;
+        entry->examined = 0;
+        if (pr->kw_table != NULL)
+        {
+            KWCACHE_kw_scan(entry, pr, str);
         }
-        kwcache->next = (cleri_kwcache_t *) malloc(sizeof(cleri_kwcache_t));
-        if (kwcache->next == NULL)
+        else
         {
-            return -1;
+            KWCACHE_kw_match(entry, pr, str);
         }
-        kwcache = kwcache->next;
-        kwcache->len = 0;
-        kwcache->next = NULL;
+    }
+    else
+    {
+        kwcache->hits++;
     }
 
-    kwcache->str = str;
-    KWCACHE_kw_match(kwcache, pr, str);
-    return kwcache->len;
+    cleri__parse_examined(pr, str, entry->examined);
+    return entry->len;
 }
 
 /*
- * Destroy kwcache. (parsing NULL is allowed)
+ * This function will set entry->len if a match is found. When parsing
+ * incremental, entry->examined is set as well.
+ *
+ * In case of an error, pr->is_valid is set to -1.
  */
-void cleri__kwcache_free(cleri_kwcache_t * kwcache)
+static void KWCACHE_kw_match(
+        cleri_kwcache_entry_t * entry,
+        cleri_parse_t * pr,
+        const char * str)
 {
-    cleri_kwcache_t * next;
-    while (kwcache != NULL)
+    int pcre_exec_ret;
+
+    PCRE2_SIZE * ovector;
+
+    pcre_exec_ret = cleri__regex_match(
+            pr,
+            pr->re_keywords,
+            str,
+            cleri__parse_remaining(pr, str),
+            0);
+
+    if (pcre_exec_ret >= 0)
+    {
+        ovector = pcre2_get_ovector_pointer(pr->match_data);
+        entry->len = ovector[1];
+    }
+    else if (pcre_exec_ret != PCRE2_ERROR_NOMATCH)
     {
-        next = kwcache->next;
-        free(kwcache);
-        kwcache = next;
+        pr->is_valid = -1; /* error occurred */
+        return;
+    }
+
+    if (pr->flags & CLERI_FLAG_INCREMENTAL)
+    {
+        entry->examined = cleri__regex_examined(
+                pr,
+                pr->re_keywords,
+                str,
+                pcre_exec_ret,
+                entry->len);
     }
 }
 
 /*
- * This function will set kwcache->len if a match is found.
+ * Like KWCACHE_kw_match() but for a simple keyword pattern which is matched
+ * using the keyword table of the grammar, see grammar.c.
  */
-static void KWCACHE_kw_match(
-        cleri_kwcache_t * kwcache,
+static void KWCACHE_kw_scan(
+        cleri_kwcache_entry_t * entry,
         cleri_parse_t * pr,
         const char * str)
 {
-    int pcre_exec_ret;
+    const unsigned char * pt = (const unsigned char *) str;
+    const unsigned char * kw_table = pr->kw_table;
+    size_t i = 0, n = cleri__parse_remaining(pr, str);
 
-    PCRE2_SIZE * ovector;
+    if (n && (kw_table[pt[0]] & CLERI__KW_FIRST))
+    {
+        i = 1;
+        while (i < n && (kw_table[pt[i]] & CLERI__KW_NEXT))
+        {
+            i++;
+        }
+    }
 
-    pcre_exec_ret = pcre2_match(
-                pr->re_keywords,
-                (PCRE2_SPTR8) str,
-                strlen(str),
-                0,                     // start looking at this point
-                0,                     // OPTIONS
-                pr->match_data,
-                NULL);
-
-    if (pcre_exec_ret < 0)
+    entry->len = i;
+
+    /* the first character which is not part of the keyword is examined as
+     * well, or the end of the string when the keyword ends there */
+    entry->examined = i + 1;
+}
+
+/*
+ * Returns the slot for str, which is either the slot holding str or the
+ * first empty slot. The position itself is used as hash since keywords are
+ * tested at positions close to each other.
+ */
+static cleri_kwcache_entry_t * KWCACHE_slot(
+        cleri_parse_t * pr,
+        cleri_kwcache_entry_t * entries,
+        size_t mask,
+        const char * str)
+{
+    size_t i = (size_t) (str - pr->str) & mask;
+    while (entries[i].str != NULL && entries[i].str != str)
     {
-        return;
+        i = (i + 1) & mask;
     }
+    return entries + i;
+}
 
-    ovector = pcre2_get_ovector_pointer(pr->match_data);
-    kwcache->len = ovector[1];
+/*
+ * Double the size of the hash table.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+static int KWCACHE_grow(cleri_parse_t * pr, cleri_kwcache_t * kwcache)
+{
+    size_t i, sz = (kwcache->mask + 1) * 2;
+    cleri_kwcache_entry_t * entries = (cleri_kwcache_entry_t *)
+            cleri__arena_alloc(pr->arena, sizeof(cleri_kwcache_entry_t) * sz);
 
+    if (entries == NULL)
+    {
+        return -1;
+    }
+
+    memset(entries, 0, sizeof(cleri_kwcache_entry_t) * sz);
+
+    for (i = 0; i <= kwcache->mask; i++)
+    {
+        if (kwcache->entries[i].str != NULL)
+        {
+            *KWCACHE_slot(
+                    pr,
+                    entries,
+                    sz - 1,
+                    kwcache->entries[i].str) = kwcache->entries[i];
+        }
+    }
 
+    cleri__arena_release(
+            pr->arena,
+            kwcache->entries,
+            sizeof(cleri_kwcache_entry_t) * (kwcache->mask + 1));
+    kwcache->entries = entries;
+    kwcache->mask = sz - 1;
+    return 0;
 }
@@ -99,7 +99,8 @@ static cleri_node_t *  LIST_parse(
     size_t i = 0;
     size_t j = 0;
 
-    if ((node = cleri__node_new(cl_obj, parent->str + parent->len, 0)) == NULL)
+    node = cleri__node_new(pr, cl_obj, parent->str + parent->len, 0);
+    if (node == NULL)
     {
         pr->is_valid = -1;
         return NULL;
@@ -134,16 +135,16 @@ static cleri_node_t *  LIST_parse(
             (cl_obj->via.list->max && i > cl_obj->via.list->max) ||
             ((cl_obj->via.list->opt_closing == 0) && i && i == j))
     {
-        cleri__node_free(node);
+        cleri__node_free(pr, node);
         return NULL;
     }
     parent->len += node->len;
-    if (cleri__children_add(parent->children, node))
+    if (cleri__children_add(pr, parent, node))
     {
          /* error occurred, reverse changes set mg_node to NULL */
         pr->is_valid = -1;
         parent->len -= node->len;
-        cleri__node_free(node);
+        cleri__node_free(pr, node);
         node = NULL;
     }
     return node;
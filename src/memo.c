@@ -0,0 +1,315 @@
+/*
+ * memo.c - packrat memoization of parse results by element and position.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ *
+ */
+#include <cleri/memo.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MEMO_HASH(__cl_obj, __str) \
+    ((((uintptr_t) (__cl_obj) >> 4) * 0x9e3779b1u) ^ \
+     ((uintptr_t) (__str) * 0x85ebca77u))
+
+static cleri_memo_entry_t * MEMO_slot(
+        cleri_memo_entry_t * entries,
+        size_t mask,
+        cleri_t * cl_obj,
+        const char * str);
+static int MEMO_grow(cleri_parse_t * pr, cleri_memo_t * memo);
+
+/*
+ * Returns NULL in case an error has occurred.
+ * (the memo is allocated from the parse arena, the size of the table is
+ * limited by pr->memo_max_size)
+ */
+cleri_memo_t * cleri__memo_new(cleri_parse_t * pr)
+{
+    size_t sz = CLERI__MEMO_INITIAL_SZ;
+    cleri_memo_t * memo = (cleri_memo_t *) cleri__arena_alloc(
+            pr->arena,
+            sizeof(cleri_memo_t));
+
+    if (memo == NULL)
+    {
+        return NULL;
+    }
+
+    while (sz > 1 && sz * sizeof(cleri_memo_entry_t) > pr->memo_max_size)
+    {
+        sz >>= 1;
+    }
+
+    memo->hits = 0;
+    memo->misses = 0;
+    memo->stored = 0;
+    memo->dropped = 0;
+    memo->reused = 0;
+    memo->skipped = 0;
+    memo->limit = NULL;
+    memo->size = sz * sizeof(cleri_memo_entry_t);
+    memo->max_size = pr->memo_max_size;
+    memo->n = 0;
+    memo->mask = sz - 1;
+    memo->entries = (cleri_memo_entry_t *) cleri__arena_alloc(
+            pr->arena,
+            memo->size);
+
+    if (memo->entries == NULL)
+    {
+        return NULL;
+    }
+
+    memset(memo->entries, 0, memo->size);
+    return memo;
+}
+
+/*
+ * Returns the entry for an element at a position or NULL when the result
+ * is not in the memo.
+ */
+cleri_memo_entry_t * cleri__memo_get(
+        cleri_memo_t * memo,
+        cleri_t * cl_obj,
+        const char * str)
+{
+    cleri_memo_entry_t * entry = MEMO_slot(
+            memo->entries,
+            memo->mask,
+            cl_obj,
+            str);
+
+    if (entry->cl_obj == NULL)
+    {
+        memo->misses++;
+        return NULL;
+    }
+    memo->hits++;
+    return entry;
+}
+
+/*
+ * Store the result of an element at a position. The memo holds a reference
+ * to the node so the node can be re-used after the parent is destroyed.
+ * When the table cannot grow any further, the result is simply not stored.
+ *
+ * Argument ext is the number of bytes examined from str for the result and
+ * top the furthest expecting update relative to str plus one, or 0 when
+ * there is no expecting update. Both are only used for re-using the result
+ * after an edit, see cleri__memo_rebase().
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+int cleri__memo_set(
+        cleri_parse_t * pr,
+        cleri_t * cl_obj,
+        const char * str,
+        cleri_node_t * node,
+        size_t len,
+        size_t ext,
+        size_t top)
+{
+    cleri_memo_t * memo = pr->memo;
+    cleri_memo_entry_t * entry;
+
+    /* keep the load factor below 75% */
+    if ((memo->n + 1) * 4 > (memo->mask + 1) * 3)
+    {
+        if (memo->size * 2 > memo->max_size)
+        {
+            memo->dropped++;
+            return 0;
+        }
+        if (MEMO_grow(pr, memo))
+        {
+            return -1;
+        }
+    }
+
+    entry = MEMO_slot(memo->entries, memo->mask, cl_obj, str);
+    if (entry->cl_obj == NULL)
+    {
+        memo->n++;
+    }
+
+    entry->cl_obj = cl_obj;
+    entry->str = str;
+    entry->node = node;
+    entry->len = len;
+    entry->ext = ext;
+    entry->top = top;
+    entry->state = CLERI__MEMO_NEW;
+
+    if (node != NULL && node != CLERI_EMPTY_NODE)
+    {
+        node->ref++;
+    }
+
+    memo->stored++;
+    return 0;
+}
+
+/*
+ * Returns a new memo for parsing pr->str, with all results from the memo of
+ * a previous parse which are not affected by an edit. The edit has replaced
+ * `deleted` bytes at offset in prev->str and resulted in pr->str.
+ *
+ * A result is not affected when the bytes examined for the result are all
+ * before the edit, or when the result starts after the deleted bytes. In the
+ * last case the position is moved with the difference in length.
+ *
+ * The arena of prev must be moved to pr already, so the nodes of the results
+ * are shared with the new parse. A node is moved to the new string once the
+ * result is used, see PARSE_memo() in parse.c. Results which are still marked
+ * as old are not used by prev so these are left out, which keeps the memo
+ * limited to the results of the last parse. The memo of prev is returned to
+ * the arena. Returns NULL in case of an error.
+ */
+cleri_memo_t * cleri__memo_rebase(
+        cleri_parse_t * pr,
+        cleri_parse_t * prev,
+        size_t offset,
+        size_t deleted)
+{
+    size_t i, pos, sz, n = 0;
+    cleri_memo_entry_t * entry, * slot;
+    cleri_memo_t * memo = cleri__memo_new(pr);
+
+    if (memo == NULL)
+    {
+        return NULL;
+    }
+
+    /* the results which are kept are moved to the start of the old table */
+    for (i = 0; i <= prev->memo->mask; i++)
+    {
+        entry = prev->memo->entries + i;
+        if (entry->cl_obj == NULL)
+        {
+            continue;
+        }
+
+        pos = (size_t) (entry->str - prev->str);
+
+        if (entry->state == CLERI__MEMO_OLD ||
+            (pos < offset + deleted && pos + entry->ext > offset))
+        {
+            cleri__node_free(pr, entry->node);
+            continue;
+        }
+
+        if (pos >= offset + deleted)
+        {
+            pos = pos + pr->len - prev->len;
+        }
+
+        slot = prev->memo->entries + n++;
+        *slot = *entry;
+        slot->str = pr->str + pos;
+        slot->state = CLERI__MEMO_OLD;
+    }
+
+    /* the table is still empty so the size is set at once */
+    sz = memo->mask + 1;
+    while (n * 4 > sz * 3 &&
+           sz * 2 * sizeof(cleri_memo_entry_t) <= memo->max_size)
+    {
+        sz <<= 1;
+    }
+
+    if (sz > memo->mask + 1)
+    {
+        cleri__arena_release(pr->arena, memo->entries, memo->size);
+        memo->size = sz * sizeof(cleri_memo_entry_t);
+        memo->mask = sz - 1;
+        memo->entries = (cleri_memo_entry_t *) cleri__arena_alloc(
+                pr->arena,
+                memo->size);
+        if (memo->entries == NULL)
+        {
+            return NULL;
+        }
+        memset(memo->entries, 0, memo->size);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        entry = prev->memo->entries + i;
+        if ((memo->n + 1) * 4 > (memo->mask + 1) * 3)
+        {
+            cleri__node_free(pr, entry->node);
+            continue;
+        }
+
+        *MEMO_slot(memo->entries, memo->mask, entry->cl_obj, entry->str) =
+                *entry;
+        memo->n++;
+    }
+
+    cleri__arena_release(pr->arena, prev->memo->entries, prev->memo->size);
+    cleri__arena_release(pr->arena, prev->memo, sizeof(cleri_memo_t));
+    prev->memo = NULL;
+
+    return memo;
+}
+
+/*
+ * Returns the slot for an element at a position. This is either the slot
+ * holding the element or the first empty slot. (linear probing)
+ */
+static cleri_memo_entry_t * MEMO_slot(
+        cleri_memo_entry_t * entries,
+        size_t mask,
+        cleri_t * cl_obj,
+        const char * str)
+{
+    size_t i = MEMO_HASH(cl_obj, str) & mask;
+
+    while (entries[i].cl_obj != NULL &&
+           (entries[i].cl_obj != cl_obj || entries[i].str != str))
+    {
+        i = (i + 1) & mask;
+    }
+    return entries + i;
+}
+
+/*
+ * Double the size of the table. The old table is returned to the arena.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+static int MEMO_grow(cleri_parse_t * pr, cleri_memo_t * memo)
+{
+    size_t i;
+    size_t size = memo->size * 2;
+    size_t mask = (memo->mask << 1) | 1;
+    cleri_memo_entry_t * entry;
+    cleri_memo_entry_t * entries = (cleri_memo_entry_t *) cleri__arena_alloc(
+            pr->arena,
+            size);
+
+    if (entries == NULL)
+    {
+        return -1;
+    }
+
+    memset(entries, 0, size);
+
+    for (i = 0; i <= memo->mask; i++)
+    {
+        entry = memo->entries + i;
+        if (entry->cl_obj != NULL)
+        {
+            *MEMO_slot(entries, mask, entry->cl_obj, entry->str) = *entry;
+        }
+    }
+
+    cleri__arena_release(pr->arena, memo->entries, memo->size);
+
+    memo->entries = entries;
+    memo->size = size;
+    memo->mask = mask;
+    return 0;
+}
@@ -11,7 +11,16 @@
  *
  */
 #include <cleri/node.h>
+#include <cleri/parse.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+static size_t NODE_count(cleri_node_t * node);
+static int NODE_walk(
+        cleri_node_t * node,
+        size_t * n,
+        cleri__node_visit_t visit,
+        void * data);
 
 static cleri_node_t CLERI__EMPTY_NODE = {
         .children=NULL,
@@ -24,33 +33,44 @@ cleri_node_t * CLERI_EMPTY_NODE = &CLERI__EMPTY_NODE;
 
 /*
  * Returns NULL in case an error has occurred.
+ * (nodes are allocated from the parse arena)
  */
-cleri_node_t * cleri__node_new(cleri_t * cl_obj, const char * str, size_t len)
+cleri_node_t * cleri__node_new(
+        cleri_parse_t * pr,
+        cleri_t * cl_obj,
+        const char * str,
+        size_t len)
 {
     cleri_node_t * node;
-    node = (cleri_node_t *) malloc(sizeof(cleri_node_t));
+    node = (cleri_node_t *) cleri__arena_alloc(
+            pr->arena,
+            sizeof(cleri_node_t));
 
     if (node != NULL)
     {
         node->cl_obj = cl_obj;
         node->ref = 1;
+        node->gen = pr->gen;
+        node->nchildren = 0;
 
         node->str = str;
         node->len = len;
 
-        if (cl_obj == NULL || cl_obj->tp <= CLERI_TP_THIS)
+        if ((~pr->flags & CLERI_FLAG_VALIDATE) &&
+            (cl_obj == NULL || cl_obj->tp <= CLERI_TP_THIS))
         {
             /* NULL when initializing the root node but we do need children */
-            node->children = cleri__children_new();
+            node->children = cleri__children_new(pr);
             if (node->children == NULL)
             {
-                free(node);
+                cleri__arena_release(pr->arena, node, sizeof(cleri_node_t));
                 return NULL;
             }
         }
         else
         {
-            /* we do not need children for some objects */
+            /* we do not need children for some objects, or for any object
+             * when only validating */
             node->children = NULL;
         }
     }
@@ -58,16 +78,129 @@ cleri_node_t * cleri__node_new(cleri_t * cl_obj, const char * str, size_t len)
 }
 
 /*
- * Destroy node. (parsing NULL is allowed)
+ * Release a node so it can be re-used within the same parse. This is only
+ * required while parsing, the parse tree itself is destroyed together with
+ * the arena. (parsing NULL is allowed)
  */
-void cleri__node_free(cleri_node_t * node)
+void cleri__node_free(cleri_parse_t * pr, cleri_node_t * node)
 {
     /* node can be NULL or this could be an CLERI_EMPTY_NODE */
     if (node == NULL || node == CLERI_EMPTY_NODE || --node->ref)
     {
         return;
     }
-    cleri__children_free(node->children);
-    free(node);
+    cleri__children_free(pr, node);
+    cleri__arena_release(pr->arena, node, sizeof(cleri_node_t));
+}
+
+
+/*
+ * Move a node from a previous parse, including all children, to str. The
+ * children are moved along, except the ones which are already moved by pr
+ * since a child can be shared by nodes of multiple results.
+ */
+void cleri__node_move(
+        cleri_parse_t * pr,
+        cleri_node_t * node,
+        const char * str)
+{
+    const char * prev = node->str;
+    cleri_node_t * child;
+    uint32_t i;
+
+    node->str = str;
+    node->gen = pr->gen;
+
+    for (i = 0; node->children != NULL && i < node->nchildren; i++)
+    {
+        child = node->children[i].node;
+        if (child->gen != pr->gen)
+        {
+            cleri__node_move(pr, child, str + (child->str - prev));
+        }
+    }
+}
+
+/*
+ * Returns the number of nodes in the parse tree of pr, or 0 when the tree
+ * cannot be exported with 32-bit offsets; both the parsed string and the
+ * number of nodes must be smaller than 4 GiB. (the root node is always
+ * counted so a tree which can be exported never returns 0)
+ */
+size_t cleri__node_export_count(cleri_parse_t * pr)
+{
+    size_t n;
+
+    if (pr->len > UINT32_MAX)
+    {
+        return 0;
+    }
+
+    n = NODE_count(pr->tree);
+    return (n > UINT32_MAX) ? 0 : n;
+}
+
+/*
+ * Walk a node and all children in pre-order. The visit function is called
+ * for each node before the children with end set to 0, and after the
+ * children with end set to the pre-order index of the first node after the
+ * subtree. Argument idx is the pre-order index of the node, starting at 0.
+ *
+ * Returns 0 if successful or -1 when a visit has failed, in which case the
+ * walk stops.
+ */
+int cleri__node_walk(
+        cleri_node_t * node,
+        cleri__node_visit_t visit,
+        void * data)
+{
+    size_t n = 0;
+    return NODE_walk(node, &n, visit, data);
+}
+
+/*
+ * Returns the number of nodes in a tree.
+ */
+static size_t NODE_count(cleri_node_t * node)
+{
+    size_t i, n = 1;
+    if (node->children != NULL)
+    {
+        for (i = 0; i < node->nchildren; i++)
+        {
+            n += NODE_count(node->children[i].node);
+        }
+    }
+    return n;
 }
 
+/*
+ * Walk a node and all children, n is the pre-order index of node and is set
+ * to the index after the subtree. See cleri__node_walk().
+ */
+static int NODE_walk(
+        cleri_node_t * node,
+        size_t * n,
+        cleri__node_visit_t visit,
+        void * data)
+{
+    size_t i, idx = (*n)++;
+
+    if (visit(node, idx, 0, data))
+    {
+        return -1;
+    }
+
+    if (node->children != NULL)
+    {
+        for (i = 0; i < node->nchildren; i++)
+        {
+            if (NODE_walk(node->children[i].node, n, visit, data))
+            {
+                return -1;
+            }
+        }
+    }
+
+    return visit(node, idx, *n, data) ? -1 : 0;
+}
@@ -66,42 +66,6 @@ int cleri__olist_append(cleri_olist_t * olist, cleri_t * cl_object)
     return 0;
 }
 
-/*
- * Exactly the same as cleri__olist_append, except the reference counter
- * will not be incremented.
- */
-int cleri__olist_append_nref(cleri_olist_t * olist, cleri_t * cl_object)
-{
-    if (cl_object == NULL)
-    {
-        return -1;
-    }
-
-    if (olist->cl_obj == NULL)
-    {
-        olist->cl_obj = cl_object;
-        olist->next = NULL;
-        return 0;
-    }
-
-    while (olist->next != NULL)
-    {
-        olist = olist->next;
-    }
-
-    olist->next = (cleri_olist_t *) malloc(sizeof(cleri_olist_t));
-
-    if (olist->next == NULL)
-    {
-        return -1;
-    }
-
-    olist->next->cl_obj = cl_object;
-    olist->next->next = NULL;
-
-    return 0;
-}
-
 /*
  * Destroy the olist and decrement the reference counter for each object in
  * the list. (NULL is allowed as olist and does nothing)
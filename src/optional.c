@@ -79,7 +79,8 @@ static cleri_node_t * OPTIONAL_parse(
     cleri_node_t * node;
     cleri_node_t * rnode;
 
-    if ((node = cleri__node_new(cl_obj, parent->str + parent->len, 0)) == NULL)
+    node = cleri__node_new(pr, cl_obj, parent->str + parent->len, 0);
+    if (node == NULL)
     {
         pr->is_valid = -1;
         return NULL;
@@ -93,17 +94,17 @@ static cleri_node_t * OPTIONAL_parse(
     if (rnode != NULL)
     {
         parent->len += node->len;
-        if (cleri__children_add(parent->children, node))
+        if (cleri__children_add(pr, parent, node))
         {
              /* error occurred, reverse changes set mg_node to NULL */
             pr->is_valid = -1;
             parent->len -= node->len;
-            cleri__node_free(node);
+            cleri__node_free(pr, node);
             node = NULL;
         }
         return node;
     }
 
-    cleri__node_free(node);
+    cleri__node_free(pr, node);
     return CLERI_EMPTY_NODE;
 }
@@ -12,44 +12,588 @@
 #include <cleri/expecting.h>
 #include <cleri/parse.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdio.h>
 
+static cleri_parse_t * PARSE_new(cleri_grammar_t * grammar);
+static int PARSE_run(
+        cleri_parse_t * pr,
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        int flags);
+static int PARSE_expecting(cleri_parse_t * pr, cleri_grammar_t * grammar);
+static int PARSE_too_deep(cleri_parse_t * pr);
+static cleri_memo_t * PARSE_move(
+        cleri_parse_t * pr,
+        cleri_parse_t * prev,
+        size_t offset,
+        size_t deleted);
+static int PARSE_gids(
+        cleri_parse_t * pr,
+        const uint32_t * gids,
+        size_t n,
+        bool filter);
+static int PARSE_jit_stack(cleri_parse_t * pr);
+static int PARSE_feed(cleri_parser_t * parser);
+static void PARSE_feed_reset(cleri_parser_t * parser);
+static int PARSE_gid_cmp(const void * a, const void * b);
+static cleri_node_t * PARSE_memo(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_t * cl_obj,
+        cleri_rule_store_t * rule);
+
 /*
  * Return a parse result. In case of a memory allocation error the return value
  * will be NULL.
  */
 cleri_parse_t * cleri_parse(cleri_grammar_t * grammar, const char * str)
 {
-    cleri_parse_t * pr;
-    const char * end;
-    const char * test;
-    bool at_end = true;
+    return cleri_parse_n(grammar, str, strlen(str));
+}
+
+/*
+ * Like cleri_parse() but parses exactly len bytes from str. The string does
+ * not need to be terminated with a null character so it is possible to parse
+ * a buffer without making a copy first.
+ */
+cleri_parse_t * cleri_parse_n(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len)
+{
+    return cleri_parse2(grammar, str, len, 0);
+}
+
+/*
+ * Like cleri_parse_n() but with flags to change the parse behavior.
+ *
+ *  - CLERI_FLAG_VALIDATE: only validate the string, no parse tree is created
+ *    so pr->tree has no children.
+ *  - CLERI_FLAG_EXPECTING_DISABLED: do not keep track of expected elements
+ *    while parsing. Only when the string is invalid, the expected elements
+ *    are calculated using a second pass. For a valid string pr->expect is
+ *    NULL. (no second pass is done in combination with CLERI_FLAG_VALIDATE)
+ *  - CLERI_FLAG_MEMO: remember the result of each element at each position
+ *    so no element is parsed twice at the same position. This guarantees
+ *    linear parse time at the cost of memory. Statistics are available in
+ *    pr->memo. Since a result taken from the memo does not update the
+ *    expected elements, pr->expect might be slightly different. Combine with
+ *    CLERI_FLAG_EXPECTING_DISABLED to get exact expected elements.
+ *  - CLERI_FLAG_INCREMENTAL: like CLERI_FLAG_MEMO but for each result the
+ *    examined part of the string is stored as well, so the results can be
+ *    re-used by cleri_parse_edit().
+ */
+cleri_parse_t * cleri_parse2(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        int flags)
+{
+    cleri_parse_t * pr = PARSE_new(grammar);
+
+    if (pr != NULL && PARSE_run(pr, grammar, str, len, flags))
+    {
+        cleri_parse_free(pr);
+        return NULL;
+    }
+
+    return pr;
+}
+
+/*
+ * Parse a string after a small edit of the string parsed by prev. Argument str
+ * is the new string with length len, and the edit has replaced `deleted`
+ * bytes at offset in the previous string. (with any number of bytes)
+ *
+ * Results from prev which are not affected by the edit are re-used, so the
+ * parse time mostly depends on the size of the edit. This requires prev to be
+ * parsed with CLERI_FLAG_INCREMENTAL, otherwise the string is parsed from
+ * scratch. The new parse uses the same flags and limits as prev. (the string
+ * parsed by prev is not used so that one may already be changed)
+ *
+ * The nodes of prev are moved to the new parse instead of being copied, so
+ * prev can only be destroyed using cleri_parse_free() afterwards, also when
+ * this function fails.
+ *
+ * The result is equal to cleri_parse2() with the same flags, including the
+ * expected elements. Returns NULL in case of a memory allocation error.
+ */
+cleri_parse_t * cleri_parse_edit(
+        cleri_grammar_t * grammar,
+        cleri_parse_t * prev,
+        const char * str,
+        size_t len,
+        size_t offset,
+        size_t deleted)
+{
+    cleri_parse_t * pr = PARSE_new(grammar);
 
-    /* prepare parsing */
-    pr = (cleri_parse_t *) malloc(sizeof(cleri_parse_t));
     if (pr == NULL)
     {
         return NULL;
     }
 
     pr->str = str;
-    pr->tree = NULL;
-    pr->kwcache = NULL;
-    pr->expecting = NULL;
-    pr->is_valid = 0;
+    pr->len = len;
+    pr->memo_max_size = prev->memo_max_size;
+    pr->stack_limit = prev->stack_limit;
+
+    if ((   prev->gid_filter &&
+            PARSE_gids(pr, prev->gids, prev->ngids, true)) ||
+        (   (prev->flags & CLERI_FLAG_INCREMENTAL) &&
+            prev->memo != NULL &&
+            offset <= prev->len &&
+            deleted <= prev->len - offset &&
+            len >= prev->len - deleted &&
+            (pr->memo = PARSE_move(pr, prev, offset, deleted)) == NULL) ||
+        PARSE_run(pr, grammar, str, len, prev->flags))
+    {
+        cleri_parse_free(pr);
+        return NULL;
+    }
+
+    return pr;
+}
+
+/*
+ * Returns 1 (TRUE) when the string is valid, 0 (FALSE) if not, or -1 in case
+ * of a memory allocation error. If pos is not NULL, pos will be set to the
+ * position where the string was successfully parsed.
+ *
+ * No parse tree is created so this is faster than checking the is_valid
+ * property of a parse result.
+ */
+int cleri_validate(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t * pos)
+{
+    int is_valid;
+    cleri_parse_t * pr = cleri_parse2(
+            grammar,
+            str,
+            strlen(str),
+            CLERI_FLAG_VALIDATE|CLERI_FLAG_EXPECTING_DISABLED);
+
+    if (pr == NULL)
+    {
+        return -1;
+    }
+
+    is_valid = pr->is_valid;
+    if (pos != NULL)
+    {
+        *pos = pr->pos;
+    }
+
+    cleri_parse_free(pr);
+    return is_valid;
+}
+
+/*
+ * Destroy parser. The parse tree, keyword cache and expecting lists are all
+ * allocated from the arena so they are released at once.
+ */
+void cleri_parse_free(cleri_parse_t * pr)
+{
+    free(pr->gids);
+    pcre2_match_data_free(pr->match_data);
+    pcre2_match_context_free(pr->match_context);
+    pcre2_jit_stack_free(pr->jit_stack);
+    cleri__arena_free(pr->arena);
+    free(pr);
+}
+
+/*
+ * Returns a parser context or NULL in case of an error.
+ *
+ * A parser context can be used for parsing strings using the same grammar
+ * over and over again. Memory from a previous parse is kept and re-used by
+ * the next parse. The flags are used for each parse, see cleri_parse2().
+ */
+cleri_parser_t * cleri_parser_new(cleri_grammar_t * grammar, int flags)
+{
+    cleri_parser_t * parser =
+            (cleri_parser_t *) malloc(sizeof(cleri_parser_t));
+
+    if (parser == NULL)
+    {
+        return NULL;
+    }
+
+    parser->grammar = grammar;
+    parser->flags = flags;
+    parser->buf = NULL;
+    parser->buf_len = 0;
+    parser->buf_sz = 0;
+    parser->feed = NULL;
+    parser->finished = false;
+    parser->pr = PARSE_new(grammar);
+
+    if (parser->pr == NULL)
+    {
+        free(parser);
+        return NULL;
+    }
+
+    if (PARSE_jit_stack(parser->pr))
+    {
+        cleri_parse_free(parser->pr);
+        free(parser);
+        return NULL;
+    }
+
+    return parser;
+}
+
+/*
+ * Returns a parse result or NULL in case of a memory allocation error.
+ *
+ * The parse result is owned by the parser context and remains valid until
+ * the next call to this function or until the parser context is destroyed.
+ * Do not call cleri_parse_free() on the result.
+ */
+cleri_parse_t * cleri_parser_parse(
+        cleri_parser_t * parser,
+        const char * str,
+        size_t len)
+{
+    cleri_parse_t * pr = parser->pr;
+
+    cleri__arena_reset(pr->arena);
+    pr->memo = NULL;
+
+    return PARSE_run(pr, parser->grammar, str, len, parser->flags) ?
+            NULL : pr;
+}
+
+/*
+ * Append a chunk of the string to parse. The chunk is copied to a buffer
+ * owned by the parser context, so the chunk itself can be re-used as soon as
+ * this function returns. Call cleri_parse_finish() when all chunks are fed.
+ *
+ * The chunks which are received so far are parsed using CLERI_FLAG_INCREMENTAL,
+ * each time the buffer has doubled in size since the last parse. A next parse
+ * is an edit which appends to the string, see cleri_parse_edit(), so results
+ * which do not depend on the end of the string are re-used. Parsing this way
+ * overlaps with receiving the next chunks, while the total time stays linear
+ * in the length of the string.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+int cleri_parse_feed(cleri_parser_t * parser, const char * chunk, size_t len)
+{
+    char * buf;
+    size_t sz = (parser->buf_sz) ? parser->buf_sz : CLERI__PARSER_BUF_SZ;
+    size_t parsed;
+
+    if (parser->finished)
+    {
+        /* the first chunk of a new string */
+        PARSE_feed_reset(parser);
+    }
+
+    while (sz - parser->buf_len < len)
+    {
+        if (sz > SIZE_MAX / 2)
+        {
+            return -1;
+        }
+        sz *= 2;
+    }
+
+    if (sz != parser->buf_sz)
+    {
+        /* the string of a previous parse is not used by an edit */
+        buf = (char *) realloc(parser->buf, sz);
+        if (buf == NULL)
+        {
+            return -1;
+        }
+        parser->buf = buf;
+        parser->buf_sz = sz;
+    }
+
+    memcpy(parser->buf + parser->buf_len, chunk, len);
+    parser->buf_len += len;
+
+    parsed = (parser->feed == NULL) ? 0 : parser->feed->len;
+    return (parser->buf_len < CLERI__PARSER_BUF_SZ ||
+            parser->buf_len - parsed < parsed) ? 0 : PARSE_feed(parser);
+}
+
+/*
+ * Parse the chunks which are not parsed yet and return the result for all
+ * chunks which are fed using cleri_parse_feed() since the last call to this
+ * function, or NULL in case of a memory allocation error. The result is equal
+ * to cleri_parse2() using the chunks as one string and the flags of the parser
+ * context, with CLERI_FLAG_INCREMENTAL added. Chunks which are fed after this
+ * call are part of a new string.
+ *
+ * The parse result is owned by the parser context and remains valid until the
+ * next call to cleri_parse_feed() or cleri_parse_finish(), or until the parser
+ * context is destroyed. Do not call cleri_parse_free() on the result.
+ */
+cleri_parse_t * cleri_parse_finish(cleri_parser_t * parser)
+{
+    if (parser->finished)
+    {
+        /* no chunks are fed since the last call, this is an empty string */
+        PARSE_feed_reset(parser);
+    }
+
+    if ((   parser->feed == NULL ||
+            parser->feed->len != parser->buf_len) &&
+        PARSE_feed(parser))
+    {
+        return NULL;
+    }
+
+    parser->finished = true;
+    return parser->feed;
+}
+
+/*
+ * Set the maximum size in bytes of the memo table which is used when parsing
+ * with CLERI_FLAG_MEMO. When the table is full, new results are no longer
+ * stored. The default is CLERI__MEMO_DEFAULT_MAX_SIZE.
+ */
+void cleri_parser_set_memo_max_size(
+        cleri_parser_t * parser,
+        size_t max_size)
+{
+    parser->pr->memo_max_size = max_size;
+}
+
+/*
+ * Set the maximum number of bytes of stack a parse may use. Parsing is
+ * recursive so the stack usage depends on how deep the input is nested. When
+ * the limit is reached, parsing stops and the result is invalid with
+ * too_deep set to true. The default is the limit of the grammar, see
+ * cleri_grammar_set_stack_limit(), use 0 for no limit.
+ */
+void cleri_parser_set_stack_limit(cleri_parser_t * parser, size_t size)
+{
+    parser->pr->stack_limit = (size) ? size : SIZE_MAX;
+}
+
+/*
+ * Only keep nodes for elements with a gid in gids in the parse tree. Other
+ * nodes are left out while parsing and their children are moved to the
+ * parent node, so the tree only contains the nodes of interest. The str and
+ * len of each node are not affected. Use NULL for gids to keep all nodes,
+ * which is the default.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+int cleri_parser_set_gid_filter(
+        cleri_parser_t * parser,
+        const uint32_t * gids,
+        size_t n)
+{
+    return PARSE_gids(parser->pr, gids, (gids == NULL) ? 0 : n, gids != NULL);
+}
+
+/*
+ * Destroy a parser context including the last parse result.
+ */
+void cleri_parser_free(cleri_parser_t * parser)
+{
+    PARSE_feed_reset(parser);
+    free(parser->buf);
+    cleri_parse_free(parser->pr);
+    free(parser);
+}
+
+/*
+ * Reset expect to start
+ */
+void cleri_parse_expect_start(cleri_parse_t * pr)
+{
+    pr->expect = pr->expecting->required;
+}
+
+/*
+ * Like cleri_parse2() but elements are reported to sax while parsing, see
+ * cleri_parse_sax(). Expecting is disabled and no second pass is done for
+ * an invalid string, only pr->pos is set. Returns NULL in case of an error.
+ */
+cleri_parse_t * cleri__parse_sax(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        cleri_sax_ctx_t * sax)
+{
+    cleri_parse_t * pr = PARSE_new(grammar);
+
+    if (pr != NULL)
+    {
+        pr->sax = sax;
+        if (PARSE_run(pr, grammar, str, len, CLERI_FLAG_EXPECTING_DISABLED))
+        {
+            cleri_parse_free(pr);
+            return NULL;
+        }
+    }
+
+    return pr;
+}
+
+/*
+ * Walk a parser object.
+ * (recursive function, called from each parse_object function)
+ * Returns a node or NULL. (In case of error one should check pr->is_valid)
+ */
+cleri_node_t * cleri__parse_walk(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_t * cl_obj,
+        cleri_rule_store_t * rule,
+        int mode)
+{
+    const char * end = pr->str + pr->len;
+    uintptr_t sp = (uintptr_t) &end;
+
+    /* stop as soon as an error has occurred so the recursion unwinds without
+     * trying the remaining alternatives */
+    if (pr->is_valid == -1)
+    {
+        return NULL;
+    }
+
+    /* stop when the stack limit is reached; the stack might grow in either
+     * direction. addresses are compared as integers since the pointers are
+     * to different objects. the recursion unwinds like for an error and the
+     * result is made invalid afterwards, see PARSE_too_deep() */
+    if ((sp < pr->stack ? pr->stack - sp : sp - pr->stack) > pr->stack_limit)
+    {
+        if (!pr->too_deep)
+        {
+            pr->too_deep = true;
+            pr->pos = (size_t) (parent->str + parent->len - pr->str);
+        }
+        pr->is_valid = -1;
+        return NULL;
+    }
+
+    /* set parent len to next none white space char */
+    while (parent->str + parent->len < end &&
+           isspace(*(parent->str + parent->len)))
+    {
+        parent->len++;
+    }
+
+    /* set expecting mode */
+    if (pr->expecting->enabled &&
+        cleri__expecting_set_mode(pr->expecting, parent->str, mode) == -1)
+    {
+        pr->is_valid = -1;
+        return NULL;
+    }
+
+    /* report elements while parsing, memoization is not used */
+    if (pr->sax != NULL)
+    {
+        return cleri__sax_walk(pr, parent, cl_obj, rule, mode);
+    }
 
-    if (    (pr->tree = cleri__node_new(NULL, str, 0)) == NULL ||
-            (pr->kwcache = cleri__kwcache_new()) == NULL ||
-            (pr->expecting = cleri__expecting_new(str)) == NULL)
+    /* results within a prio depend on the rule, except for a rule itself
+     * which starts a new rule store. a terminal element is matched faster
+     * than a result is stored so these are not in the memo */
+    if (pr->memo != NULL &&
+        cl_obj->tp <= CLERI_TP_THIS &&
+        (rule == NULL || cl_obj->tp == CLERI_TP_RULE))
+    {
+        return PARSE_memo(pr, parent, cl_obj, rule);
+    }
+
+    /* note that the actual node is returned or NULL but we do not
+     * actually need the node. (boolean true/false would be enough)
+     */
+    return (*cl_obj->parse_object)(pr, parent, cl_obj, rule);
+}
+
+/*
+ * Returns a new parse object or NULL in case of an error. The parse object
+ * can be used for parsing more than once when the arena is reset. The stack
+ * limit is taken from the grammar.
+ */
+static cleri_parse_t * PARSE_new(cleri_grammar_t * grammar)
+{
+    cleri_parse_t * pr = (cleri_parse_t *) malloc(sizeof(cleri_parse_t));
+    if (pr == NULL)
+    {
+        return NULL;
+    }
+
+    /* match data is owned by the parse so the grammar can be shared by
+     * multiple threads. only the start and end of a match are used, so a
+     * single pair is sufficient for all regular expressions. */
+    pr->match_data = pcre2_match_data_create(1, NULL);
+    pr->match_context = NULL;
+    pr->jit_stack = NULL;
+    pr->arena = cleri__arena_new();
+    pr->memo_max_size = CLERI__MEMO_DEFAULT_MAX_SIZE;
+    pr->memo = NULL;
+    pr->gen = false;
+    pr->stack_limit = grammar->stack_limit;
+    pr->gid_filter = false;
+    pr->gids = NULL;
+    pr->ngids = 0;
+    pr->sax = NULL;
+
+    if (pr->match_data == NULL || pr->arena == NULL)
     {
         cleri_parse_free(pr);
         return NULL;
     }
 
+    return pr;
+}
+
+/*
+ * Parse a string. All memory is allocated from the arena of the parse object.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+static int PARSE_run(
+        cleri_parse_t * pr,
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        int flags)
+{
+    const char * end;
+    const char * test;
+    bool at_end = true;
+
+    pr->str = str;
+    pr->len = len;
+    pr->is_valid = 0;
+    pr->too_deep = false;
+    pr->flags = flags;
     pr->re_keywords = grammar->re_keywords;
-    pr->match_data = grammar->match_data;
+    pr->kw_table = (grammar->kw_scan) ? grammar->kw_table : NULL;
+    pr->re_options = (grammar->jit) ? 0 : PCRE2_NO_JIT;
+    pr->stack = (uintptr_t) &end;
+    pr->ext = 0;
+
+    if (    (pr->tree = cleri__node_new(pr, NULL, str, 0)) == NULL ||
+            ((flags & (CLERI_FLAG_MEMO|CLERI_FLAG_INCREMENTAL)) &&
+                pr->memo == NULL &&
+                (pr->memo = cleri__memo_new(pr)) == NULL) ||
+            (pr->kwcache = cleri__kwcache_new(pr)) == NULL ||
+            (pr->expecting = cleri__expecting_new(
+                    pr->arena,
+                    str,
+                    (~flags & CLERI_FLAG_EXPECTING_DISABLED))) == NULL)
+    {
+        return -1;
+    }
 
     /* do the actual parsing */
     cleri__parse_walk(
@@ -59,18 +603,18 @@ cleri_parse_t * cleri_parse(cleri_grammar_t * grammar, const char * str)
             NULL,
             CLERI__EXP_MODE_REQUIRED);
 
-    /* When is_valid is -1, an allocation error has occurred. */
+    /* When is_valid is -1, an allocation error has occurred or the input is
+     * nested too deep. */
     if (pr->is_valid == -1)
     {
-        cleri_parse_free(pr);
-        return NULL;
+        return PARSE_too_deep(pr);
     }
 
     /* process the parse result */
     end = pr->tree->str + pr->tree->len;
 
     /* check if we are at the end of the string */
-    for (test = end; *test; test++)
+    for (test = end; test < str + len; test++)
     {
         if (!isspace(*test))
         {
@@ -83,6 +627,34 @@ cleri_parse_t * cleri_parse(cleri_grammar_t * grammar, const char * str)
     pr->pos = (pr->is_valid) ?
             pr->tree->len : (size_t) (pr->expecting->str - pr->str);
 
+    if (!pr->expecting->enabled)
+    {
+        if (at_end || (flags & CLERI_FLAG_VALIDATE) || pr->sax != NULL)
+        {
+            pr->expect = NULL;
+            return 0;
+        }
+        if (PARSE_expecting(pr, grammar))
+        {
+            return PARSE_too_deep(pr);
+        }
+    }
+    else if (pr->memo != NULL &&
+             pr->memo->skipped > (size_t) (pr->expecting->str - pr->str))
+    {
+        /* results from a previous parse are used and the expecting updates
+         * made by these results might be relevant */
+        if (PARSE_expecting(pr, grammar))
+        {
+            return PARSE_too_deep(pr);
+        }
+    }
+
+    if (!at_end)
+    {
+        pr->pos = (size_t) (pr->expecting->str - pr->str);
+    }
+
     if (!at_end && pr->expecting->required->cl_obj == NULL)
     {
         if (cleri__expecting_set_mode(
@@ -94,8 +666,7 @@ cleri_parse_t * cleri_parse(cleri_grammar_t * grammar, const char * str)
                 CLERI_END_OF_STATEMENT,
                 end) == -1)
         {
-            cleri_parse_free(pr);
-            return NULL;
+            return -1;
         }
     }
 
@@ -103,58 +674,410 @@ cleri_parse_t * cleri_parse(cleri_grammar_t * grammar, const char * str)
 
     pr->expect = pr->expecting->required;
 
-    return pr;
+    return 0;
 }
 
 /*
- * Destroy parser. (parsing NULL is allowed)
+ * Finish a parse which is stopped by an error. When the stack limit is
+ * reached the result is an invalid parse with an empty tree, no expected
+ * elements and pos set to where the limit was reached.
+ *
+ * Returns 0 if the stack limit is reached or -1 in case of a memory
+ * allocation error.
  */
-void cleri_parse_free(cleri_parse_t * pr)
+static int PARSE_too_deep(cleri_parse_t * pr)
 {
-    cleri__node_free(pr->tree);
-    cleri__kwcache_free(pr->kwcache);
-    if (pr->expecting != NULL)
+    if (!pr->too_deep)
     {
-        cleri__expecting_free(pr->expecting);
+        return -1;
     }
-    free(pr);
+
+    pr->is_valid = 0;
+    pr->expect = NULL;
+    cleri__node_free(pr, pr->tree);
+    cleri__expecting_free(pr->expecting);
+    if ((pr->tree = cleri__node_new(pr, NULL, pr->str, 0)) == NULL ||
+        (pr->expecting = cleri__expecting_new(
+                pr->arena,
+                pr->str,
+                false)) == NULL)
+    {
+        return -1;
+    }
+    return 0;
 }
 
 /*
- * Reset expect to start
+ * Move the arena of prev, including the nodes of prev, to pr and return a
+ * memo with the results of prev which are not affected by an edit, see
+ * cleri__memo_rebase(). The tree and other parts of prev are returned to the
+ * arena so the arena does not grow with each edit.
+ *
+ * Returns NULL in case of an error.
  */
-void cleri_parse_expect_start(cleri_parse_t * pr)
+static cleri_memo_t * PARSE_move(
+        cleri_parse_t * pr,
+        cleri_parse_t * prev,
+        size_t offset,
+        size_t deleted)
 {
-    pr->expect = pr->expecting->required;
+    cleri_arena_t * arena = pr->arena;
+
+    pr->arena = prev->arena;
+    prev->arena = arena;
+    pr->gen = !prev->gen;
+
+    cleri__node_free(pr, prev->tree);
+    cleri__kwcache_free(pr, prev->kwcache);
+    cleri__expecting_free(prev->expecting);
+    prev->tree = NULL;
+    prev->expect = NULL;
+    prev->expecting = NULL;
+    prev->kwcache = NULL;
+
+    return cleri__memo_rebase(pr, prev, offset, deleted);
 }
 
 /*
- * Walk a parser object.
- * (recursive function, called from each parse_object function)
- * Returns a node or NULL. (In case of error one should check pr->is_valid)
+ * Second pass for an invalid string when expecting was disabled, or when
+ * results from a previous parse might have skipped expecting updates. The
+ * string is parsed again without creating a tree, this time with expecting
+ * enabled.
+ *
+ * Only the updates at the furthest position are kept, so a result from the
+ * memo can still be used when each update made while parsing the result is
+ * before that position. Other results are parsed again and no new results
+ * are stored.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
  */
-cleri_node_t * cleri__parse_walk(
+static int PARSE_expecting(cleri_parse_t * pr, cleri_grammar_t * grammar)
+{
+    int flags = pr->flags;
+    cleri_memo_t * memo = pr->memo;
+    cleri_node_t * tree;
+
+    if (memo != NULL)
+    {
+        memo->limit = pr->expecting->str;
+        if (pr->str + memo->skipped > memo->limit + 1)
+        {
+            memo->limit = pr->str + memo->skipped - 1;
+        }
+    }
+
+    pr->flags = (flags | CLERI_FLAG_VALIDATE) & ~(
+            CLERI_FLAG_EXPECTING_DISABLED|
+            CLERI_FLAG_MEMO|
+            CLERI_FLAG_INCREMENTAL);
+
+    cleri__expecting_free(pr->expecting);
+    if (    (pr->expecting = cleri__expecting_new(
+                    pr->arena,
+                    pr->str,
+                    true)) == NULL ||
+            (tree = cleri__node_new(pr, NULL, pr->str, 0)) == NULL)
+    {
+        return -1;
+    }
+
+    cleri__parse_walk(
+            pr,
+            tree,
+            grammar->start,
+            NULL,
+            CLERI__EXP_MODE_REQUIRED);
+
+    pr->flags = flags;
+    if (memo != NULL)
+    {
+        memo->limit = NULL;
+    }
+    cleri__node_free(pr, tree);
+
+    return pr->is_valid == -1 ? -1 : 0;
+}
+
+/*
+ * Like the last step of cleri__parse_walk() but the result is taken from the
+ * memo if possible, or stored in the memo otherwise.
+ *
+ * For each result, the number of examined bytes (pr->ext) and the furthest
+ * expecting update (pr->expecting->top) are stored as well. These are only
+ * required for re-using results after an edit, see cleri_parse_edit().
+ */
+static cleri_node_t * PARSE_memo(
         cleri_parse_t * pr,
         cleri_node_t * parent,
         cleri_t * cl_obj,
-        cleri_rule_store_t * rule,
-        int mode)
+        cleri_rule_store_t * rule)
 {
-    /* set parent len to next none white space char */
-    while (isspace(*(parent->str + parent->len)))
+    size_t len = parent->len;
+    const char * str = parent->str + len;
+    size_t pos = (size_t) (str - pr->str);
+    size_t ext = pr->ext;
+    const char * top = pr->expecting->top;
+    cleri_memo_entry_t * entry = cleri__memo_get(pr->memo, cl_obj, str);
+    cleri_node_t * node;
+
+    if (pr->memo->limit != NULL &&
+        (entry == NULL || (entry->top && str + entry->top > pr->memo->limit)))
     {
-        parent->len++;
+        /* second pass for the expected elements, see PARSE_expecting() */
+        return (*cl_obj->parse_object)(pr, parent, cl_obj, rule);
     }
 
-    /* set expecting mode */
-    if (cleri__expecting_set_mode(pr->expecting, parent->str, mode) == -1)
+    if (entry == NULL)
+    {
+        /* the first character (or the end of the string) is examined by
+         * cleri__parse_walk() while skipping white space */
+        pr->ext = pos + 1;
+        pr->expecting->top = pr->str;
+
+        node = (*cl_obj->parse_object)(pr, parent, cl_obj, rule);
+
+        /* when only validating, the node is already released so the node
+         * is only used as a boolean value */
+        if (pr->is_valid != -1 && cleri__memo_set(
+                pr,
+                cl_obj,
+                str,
+                (node == NULL || (~pr->flags & CLERI_FLAG_VALIDATE)) ?
+                        node : CLERI_EMPTY_NODE,
+                parent->len - len,
+                pr->ext - pos,
+                (pr->expecting->top >= str) ?
+                        (size_t) (pr->expecting->top - str) + 1 : 0))
+        {
+            pr->is_valid = -1;
+            return NULL;
+        }
+
+        if (ext > pr->ext)
+        {
+            pr->ext = ext;
+        }
+        if (top > pr->expecting->top)
+        {
+            pr->expecting->top = top;
+        }
+        return node;
+    }
+
+    cleri__parse_examined(pr, str, entry->ext);
+
+    if (entry->top)
+    {
+        top = str + entry->top - 1;
+        if (top > pr->expecting->top)
+        {
+            pr->expecting->top = top;
+        }
+    }
+
+    /* the second pass for the expected elements uses a node from the
+     * previous parse only as a boolean value, see PARSE_expecting() */
+    if (entry->state == CLERI__MEMO_OLD && pr->memo->limit == NULL)
+    {
+        /* a result from a previous parse; expecting updates made while
+         * parsing this result are unknown so remember the furthest one */
+        pr->memo->reused++;
+        if (entry->top)
+        {
+            if (pos + entry->top > pr->memo->skipped)
+            {
+                pr->memo->skipped = pos + entry->top;
+            }
+            if (!pr->expecting->enabled && top > pr->expecting->str)
+            {
+                /* only the position is tracked so this is exact */
+                pr->expecting->str = top;
+            }
+        }
+
+        if (entry->node != NULL &&
+            entry->node != CLERI_EMPTY_NODE &&
+            entry->node->gen != pr->gen)
+        {
+            /* the node is still at the position of the previous parse */
+            cleri__node_move(pr, entry->node, str);
+        }
+        entry->state = CLERI__MEMO_NEW;
+    }
+
+    node = entry->node;
+    if (node == NULL)
     {
-        pr->is_valid = -1;
         return NULL;
     }
 
-    /* note that the actual node is returned or NULL but we do not
-     * actually need the node. (boolean true/false would be enough)
-     */
-    return (*cl_obj->parse_object)(pr, parent, cl_obj, rule);
+    parent->len += entry->len;
+    if (node == CLERI_EMPTY_NODE)
+    {
+        return node;
+    }
+
+    node->ref++;
+    if (cleri__children_add(pr, parent, node))
+    {
+         /* error occurred, reverse changes set node to NULL */
+        pr->is_valid = -1;
+        parent->len -= entry->len;
+        cleri__node_free(pr, node);
+        node = NULL;
+    }
+    return node;
+}
+
+/*
+ * Set a sorted copy of the n gids as filter for the parse tree, see
+ * cleri_parser_set_gid_filter(). The filter is removed when filter is false.
+ * An empty filter only keeps the root node.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+static int PARSE_gids(
+        cleri_parse_t * pr,
+        const uint32_t * gids,
+        size_t n,
+        bool filter)
+{
+    uint32_t * tmp = NULL;
+
+    if (filter && n)
+    {
+        if (n > SIZE_MAX / sizeof(uint32_t))
+        {
+            return -1;
+        }
+        tmp = (uint32_t *) malloc(sizeof(uint32_t) * n);
+        if (tmp == NULL)
+        {
+            return -1;
+        }
+        memcpy(tmp, gids, sizeof(uint32_t) * n);
+        qsort(tmp, n, sizeof(uint32_t), &PARSE_gid_cmp);
+    }
+
+    free(pr->gids);
+    pr->gid_filter = filter;
+    pr->gids = tmp;
+    pr->ngids = (filter) ? n : 0;
+    return 0;
+}
+
+/*
+ * Compare function for sorting gids.
+ */
+static int PARSE_gid_cmp(const void * a, const void * b)
+{
+    uint32_t ga = *((const uint32_t *) a);
+    uint32_t gb = *((const uint32_t *) b);
+    return (ga > gb) - (ga < gb);
+}
+
+/*
+ * Create a match context with a JIT stack for a parse object which is used
+ * by a parser context. The stack is owned by the parse, like the match data,
+ * so the grammar can be shared by multiple threads. A single parse does not
+ * get a JIT stack since creating one takes longer than a small parse; PCRE2
+ * then uses 32K of the machine stack. Nothing is done when PCRE2 has no JIT
+ * support.
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+static int PARSE_jit_stack(cleri_parse_t * pr)
+{
+    uint32_t jit = 0;
+
+    if (pcre2_config(PCRE2_CONFIG_JIT, &jit) < 0 || !jit)
+    {
+        return 0;
+    }
+
+    pr->match_context = pcre2_match_context_create(NULL);
+    if (pr->match_context == NULL)
+    {
+        return -1;
+    }
+
+    pr->jit_stack = pcre2_jit_stack_create(
+            CLERI__JIT_STACK_START,
+            CLERI__JIT_STACK_MAX,
+            NULL);
+    if (pr->jit_stack == NULL)
+    {
+        return -1;
+    }
+
+    pcre2_jit_stack_assign(pr->match_context, NULL, pr->jit_stack);
+    return 0;
+}
+
+/*
+ * Parse the chunks in the buffer of the parser context. A first parse uses the
+ * settings of the parser context, a next parse is an edit of the previous one
+ * which appends the chunks received since, see cleri_parse_feed().
+ *
+ * Returns 0 if successful or -1 in case of a memory allocation error.
+ */
+static int PARSE_feed(cleri_parser_t * parser)
+{
+    const char * str = (parser->buf == NULL) ? "" : parser->buf;
+    cleri_parse_t * pr;
+
+    if (parser->feed != NULL)
+    {
+        /* the previous parse is moved to the edit, also when it fails */
+        pr = cleri_parse_edit(
+                parser->grammar,
+                parser->feed,
+                str,
+                parser->buf_len,
+                parser->feed->len,
+                0);
+        cleri_parse_free(parser->feed);
+        parser->feed = pr;
+        return (pr == NULL) ? -1 : 0;
+    }
+
+    pr = PARSE_new(parser->grammar);
+    if (pr == NULL)
+    {
+        return -1;
+    }
+
+    pr->memo_max_size = parser->pr->memo_max_size;
+    pr->stack_limit = parser->pr->stack_limit;
+
+    if ((   parser->pr->gid_filter &&
+            PARSE_gids(pr, parser->pr->gids, parser->pr->ngids, true)) ||
+        PARSE_run(
+            pr,
+            parser->grammar,
+            str,
+            parser->buf_len,
+            parser->flags | CLERI_FLAG_INCREMENTAL))
+    {
+        cleri_parse_free(pr);
+        return -1;
+    }
+
+    parser->feed = pr;
+    return 0;
+}
+
+/*
+ * Destroy the parse of the chunks and empty the buffer, the buffer itself is
+ * kept for the next string.
+ */
+static void PARSE_feed_reset(cleri_parser_t * parser)
+{
+    if (parser->feed != NULL)
+    {
+        cleri_parse_free(parser->feed);
+        parser->feed = NULL;
+    }
+    parser->buf_len = 0;
+    parser->finished = false;
 }
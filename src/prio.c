@@ -53,6 +53,7 @@ cleri_t * cleri_prio(uint32_t gid, size_t len, ...)
         return NULL;
     }
 
+    cl_object->via.prio->first = NULL;
     cl_object->via.prio->olist = cleri__olist_new();
 
     if (cl_object->via.prio->olist == NULL)
@@ -84,6 +85,7 @@ cleri_t * cleri_prio(uint32_t gid, size_t len, ...)
 static void PRIO_free(cleri_t * cl_object)
 {
     cleri__olist_free(cl_object->via.prio->olist);
+    free(cl_object->via.prio->first);
     free(cl_object->via.prio);
 }
 
@@ -100,12 +102,18 @@ static cleri_node_t *  PRIO_parse(
     cleri_node_t * node;
     cleri_node_t * rnode;
     cleri_rule_tested_t * tested;
+    cleri_first_t * first = cl_obj->via.prio->first;
     const char * str = parent->str + parent->len;
+    size_t i;
 
     /* initialize and return rule test, or return an existing test
      * if *str is already in tested */
     if (    rule->depth++ > PRIO_MAX_RECURSION_DEPTH ||
-            cleri__rule_init(&tested, rule->tested, str) == CLERI_RULE_ERROR)
+            cleri__rule_init(
+                pr,
+                &tested,
+                rule,
+                str) == CLERI_RULE_ERROR)
     {
         pr->is_valid = -1;
         return NULL;
@@ -113,9 +121,14 @@ static cleri_node_t *  PRIO_parse(
 
     olist = cl_obj->via.prio->olist;
 
-    while (olist != NULL)
+    for (i = 0; olist != NULL; i++, olist = olist->next)
     {
-        if ((node = cleri__node_new(cl_obj, str, 0)) == NULL)
+        if (first != NULL &&
+            cleri__first_skip(pr, first + i, olist->cl_obj, str))
+        {
+            continue;
+        }
+        if ((node = cleri__node_new(pr, cl_obj, str, 0)) == NULL)
         {
             pr->is_valid = -1;
             return NULL;
@@ -129,25 +142,34 @@ static cleri_node_t *  PRIO_parse(
         if (rnode != NULL &&
                 (tested->node == NULL || node->len > tested->node->len))
         {
-            cleri__node_free(tested->node);
+            cleri__node_free(pr, tested->node);
             tested->node = node;
+
+            /* like a most greedy choice, see CHOICE_parse_most_greedy() */
+            if (!pr->expecting->enabled &&
+                node->len == cleri__parse_remaining(pr, str))
+            {
+                cleri__parse_examined(pr, str, node->len + 1);
+                break;
+            }
         }
         else
         {
-            cleri__node_free(node);
+            cleri__node_free(pr, node);
         }
-        olist = olist->next;
     }
     if (tested->node != NULL)
     {
+        /* the node is referenced by both the parent and the rule test */
+        tested->node->ref++;
         parent->len += tested->node->len;
-        if (cleri__children_add(parent->children, tested->node))
+        if (cleri__children_add(pr, parent, tested->node))
         {
              /* error occurred, reverse changes set mg_node to NULL */
             pr->is_valid = -1;
             parent->len -=  tested->node->len;
-            cleri__node_free(tested->node);
-            tested->node = NULL;
+            cleri__node_free(pr, tested->node);
+            return NULL;
         }
         return tested->node;
     }
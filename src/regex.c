@@ -13,15 +13,41 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <assert.h>
 
-static void REGEX_free(cleri_t * cl_object);
+#define REGEX_IS_DIGIT(__c) ((__c) >= '0' && (__c) <= '9')
+#define REGEX_IS_ALPHA(__c) ( \
+        ((__c) >= 'a' && (__c) <= 'z') || \
+        ((__c) >= 'A' && (__c) <= 'Z') || \
+        (__c) == '_')
 
+static cleri_t * REGEX_new(
+        uint32_t gid,
+        const char * pattern,
+        int matcher,
+        char quote,
+        char escape);
+static void REGEX_free(cleri_t * cl_object);
 static cleri_node_t *  REGEX_parse(
         cleri_parse_t * pr,
         cleri_node_t * parent,
         cleri_t * cl_obj,
         cleri_rule_store_t * rule);
+static int REGEX_detect(const char * pattern, char * quote, char * escape);
+static int REGEX_string_pattern(char * buf, char quote, char escape);
+static int REGEX_native(
+        cleri_regex_t * regex,
+        const char * s,
+        size_t n,
+        size_t * len,
+        size_t * examined);
+static void REGEX_first(cleri_regex_t * regex);
+static inline bool REGEX_reject(
+        cleri_regex_t * regex,
+        const char * s,
+        size_t n,
+        size_t * examined);
 
 /*
  * Returns a regex object or NULL in case of an error.
@@ -29,14 +55,96 @@ static cleri_node_t *  REGEX_parse(
  * Argument pattern must start with character '^'. Be sure to check the pattern
  * for the '^' character before calling this function.
  *
+ * Some common patterns, like the ones used by cleri_integer(), cleri_float(),
+ * cleri_identifier() and cleri_string(), are matched by a native matcher
+ * instead of PCRE2. The result is exactly the same, only faster.
+ *
  * Warning: this function could write to stderr in case the pattern could not
  * be compiled.
  */
 cleri_t * cleri_regex(uint32_t gid, const char * pattern)
+{
+    char quote = 0, escape = 0;
+    int matcher = REGEX_detect(pattern, &quote, &escape);
+    return REGEX_new(gid, pattern, matcher, quote, escape);
+}
+
+/*
+ * Returns a regex object for an integer or NULL in case of an error.
+ *
+ * Equal to cleri_regex() with pattern ^-?[0-9]+
+ */
+cleri_t * cleri_integer(uint32_t gid)
+{
+    return REGEX_new(gid, CLERI__RE_INTEGER, CLERI__REGEX_INTEGER, 0, 0);
+}
+
+/*
+ * Returns a regex object for a float or NULL in case of an error.
+ *
+ * Equal to cleri_regex() with pattern ^-?[0-9]+\.?[0-9]+ (note that this
+ * pattern requires at least two digits but no dot, like the JSON example)
+ */
+cleri_t * cleri_float(uint32_t gid)
+{
+    return REGEX_new(gid, CLERI__RE_FLOAT, CLERI__REGEX_FLOAT, 0, 0);
+}
+
+/*
+ * Returns a regex object for an identifier or NULL in case of an error.
+ *
+ * Equal to cleri_regex() with pattern ^[a-zA-Z_][a-zA-Z0-9_]*
+ */
+cleri_t * cleri_identifier(uint32_t gid)
+{
+    return REGEX_new(
+            gid,
+            CLERI__RE_IDENTIFIER,
+            CLERI__REGEX_IDENTIFIER,
+            0,
+            0);
+}
+
+/*
+ * Returns a regex object for a quoted string or NULL in case of an error.
+ *
+ * The string starts and ends with the quote character. The escape character
+ * escapes the next character, for example \" when using " and \. Use 0 as
+ * escape character when escaping is not possible. Both characters must be
+ * printable ASCII characters (no space) and must not be equal.
+ *
+ * Equal to cleri_regex() with pattern ^(")(?:(?=(\\?))\2.)*?\1 for the
+ * characters " and \, or ^(").*?\1 for the character " without escaping.
+ * Like the pattern, a string cannot contain a new line character.
+ */
+cleri_t * cleri_string(uint32_t gid, char quote, char escape)
+{
+    char pattern[CLERI__RE_STRING_SZ];
+
+    if (REGEX_string_pattern(pattern, quote, escape))
+    {
+        return NULL;
+    }
+    return REGEX_new(gid, pattern, CLERI__REGEX_STRING, quote, escape);
+}
+
+/*
+ * Returns a regex object or NULL in case of an error.
+ *
+ * The pattern is compiled, also when a native matcher is used, so the
+ * object can be used as any other regex object.
+ */
+static cleri_t * REGEX_new(
+        uint32_t gid,
+        const char * pattern,
+        int matcher,
+        char quote,
+        char escape)
 {
     cleri_t * cl_object;
     int pcre_error_num;
     PCRE2_SIZE pcre_error_offset;
+    uint32_t newline;
 
     assert (pattern[0] == '^');
 
@@ -81,20 +189,25 @@ cleri_t * cleri_regex(uint32_t gid, const char * pattern)
         return NULL;
     }
 
-    cl_object->via.regex->match_data = pcre2_match_data_create_from_pattern(
+    /* use JIT when available, otherwise the interpreter is used */
+    (void) pcre2_jit_compile(
             cl_object->via.regex->regex,
-            NULL);
+            PCRE2_JIT_COMPLETE);
 
-    if (cl_object->via.regex->match_data == NULL)
+    /* the string matcher assumes a dot matches all but a line feed */
+    if (matcher == CLERI__REGEX_STRING && (
+            pcre2_config(PCRE2_CONFIG_NEWLINE, &newline) < 0 ||
+            newline != PCRE2_NEWLINE_LF))
     {
-        pcre2_code_free(cl_object->via.regex->regex);
-        fprintf(stderr, "error: cannot create matsch data\n");
-        free(cl_object->via.regex);
-        free(cl_object);
-        return NULL;
-        return NULL;
+        matcher = CLERI__REGEX_PCRE2;
     }
 
+    cl_object->via.regex->matcher = matcher;
+    cl_object->via.regex->quote = quote;
+    cl_object->via.regex->escape = escape;
+
+    REGEX_first(cl_object->via.regex);
+
     return cl_object;
 }
 
@@ -103,7 +216,6 @@ cleri_t * cleri_regex(uint32_t gid, const char * pattern)
  */
 static void REGEX_free(cleri_t * cl_object)
 {
-    pcre2_match_data_free(cl_object->via.regex->match_data);
     pcre2_code_free(cl_object->via.regex->regex);
     free(cl_object->via.regex);
 }
@@ -118,41 +230,77 @@ static cleri_node_t *  REGEX_parse(
         cleri_rule_store_t * rule __attribute__((unused)))
 {
     int pcre_exec_ret;
+    size_t len, examined;
     PCRE2_SIZE * ovector;
     const char * str = parent->str + parent->len;
+    size_t remaining = cleri__parse_remaining(pr, str);
+    cleri_regex_t * regex = cl_obj->via.regex;
     cleri_node_t * node;
 
-    pcre_exec_ret = pcre2_match(
-            cl_obj->via.regex->regex,
-            (PCRE2_SPTR8) str,
-            strlen(str),
-            0,                     // start looking at this point
-            0,                     // OPTIONS
-            cl_obj->via.regex->match_data,
-            NULL);
+    if (regex->matcher != CLERI__REGEX_PCRE2)
+    {
+        pcre_exec_ret = REGEX_native(regex, str, remaining, &len, &examined);
+
+        if (pr->flags & CLERI_FLAG_INCREMENTAL)
+        {
+            cleri__parse_examined(pr, str, examined);
+        }
+    }
+    else if (REGEX_reject(regex, str, remaining, &examined))
+    {
+        /* the pattern cannot match, no need to call PCRE2 */
+        pcre_exec_ret = PCRE2_ERROR_NOMATCH;
+
+        if (pr->flags & CLERI_FLAG_INCREMENTAL)
+        {
+            cleri__parse_examined(pr, str, examined);
+        }
+    }
+    else
+    {
+        pcre_exec_ret = cleri__regex_match(
+                pr,
+                regex->regex,
+                str,
+                remaining,
+                0);
+
+        /* since each regex pattern should start with ^ we now sub_str_vec[0]
+         * should be 0. sub_str_vec[1] contains the end position in the sting
+         */
+        ovector = pcre2_get_ovector_pointer(pr->match_data);
+        len = (pcre_exec_ret < 0) ? 0 : (size_t) ovector[1];
+
+        if (pr->flags & CLERI_FLAG_INCREMENTAL)
+        {
+            cleri__parse_examined(pr, str, cleri__regex_examined(
+                    pr,
+                    regex->regex,
+                    str,
+                    pcre_exec_ret,
+                    len));
+        }
+    }
 
     if (pcre_exec_ret < 0)
     {
-        if (cleri__expecting_update(pr->expecting, cl_obj, str) == -1)
+        if (pcre_exec_ret != PCRE2_ERROR_NOMATCH ||
+            cleri__expecting_update(pr->expecting, cl_obj, str) == -1)
         {
             pr->is_valid = -1; /* error occurred */
         }
         return NULL;
     }
-    ovector = pcre2_get_ovector_pointer(cl_obj->via.regex->match_data);
 
-    /* since each regex pattern should start with ^ we now sub_str_vec[0]
-     * should be 0. sub_str_vec[1] contains the end position in the sting
-     */
-    if ((node = cleri__node_new(cl_obj, str, (size_t) ovector[1])) != NULL)
+    if ((node = cleri__node_new(pr, cl_obj, str, len)) != NULL)
     {
         parent->len += node->len;
-        if (cleri__children_add(parent->children, node))
+        if (cleri__children_add(pr, parent, node))
         {
              /* error occurred, reverse changes set node to NULL */
             pr->is_valid = -1;
             parent->len -= node->len;
-            cleri__node_free(node);
+            cleri__node_free(pr, node);
             node = NULL;
         }
     }
@@ -163,3 +311,368 @@ static cleri_node_t *  REGEX_parse(
 
     return node;
 }
+
+/*
+ * Match a regular expression against the first len bytes of str, using the
+ * match data and options of the parse. Returns the result of pcre2_match().
+ *
+ * JIT uses a stack with a limited size, and only 32K of the machine stack
+ * when the parse has no JIT stack. A pattern with many nested backtracking
+ * positions, like a long quoted string, may exceed this limit in which case
+ * the match is repeated using the interpreter.
+ */
+int cleri__regex_match(
+        cleri_parse_t * pr,
+        pcre2_code * re,
+        const char * str,
+        size_t len,
+        uint32_t options)
+{
+    int rc = pcre2_match(
+            re,
+            (PCRE2_SPTR8) str,
+            len,
+            0,                          // start looking at this point
+            options|pr->re_options,     // OPTIONS
+            pr->match_data,
+            pr->match_context);
+
+    if (rc == PCRE2_ERROR_JIT_STACKLIMIT)
+    {
+        rc = pcre2_match(
+                re,
+                (PCRE2_SPTR8) str,
+                len,
+                0,
+                options|PCRE2_NO_JIT,
+                pr->match_data,
+                pr->match_context);
+    }
+    return rc;
+}
+
+/*
+ * Returns the number of bytes from str which are examined by a regular
+ * expression in order to find the given result. (rc and len are the result
+ * and match length of the match against the remaining string)
+ *
+ * A regular expression can look ahead beyond the end of a match, so the
+ * match is repeated on a growing part of the string, using hard partial
+ * matching, until the result no longer depends on the rest of the string.
+ * When the result depends on the end of the string, the remaining length
+ * plus one is returned. Note that this function overwrites pr->match_data.
+ *
+ * In case of an error, pr->is_valid is set to -1.
+ */
+size_t cleri__regex_examined(
+        cleri_parse_t * pr,
+        pcre2_code * re,
+        const char * str,
+        int rc,
+        size_t len)
+{
+    int test_rc;
+    size_t remaining = cleri__parse_remaining(pr, str);
+    size_t step = 1;
+    size_t test = (rc < 0) ? 1 : len + 1;
+    PCRE2_SIZE * ovector = pcre2_get_ovector_pointer(pr->match_data);
+
+    while (test <= remaining)
+    {
+        test_rc = cleri__regex_match(
+                pr,
+                re,
+                str,
+                test,
+                PCRE2_PARTIAL_HARD);
+
+        if (test_rc < 0 &&
+            test_rc != PCRE2_ERROR_NOMATCH &&
+            test_rc != PCRE2_ERROR_PARTIAL)
+        {
+            pr->is_valid = -1; /* error occurred */
+            break;
+        }
+
+        if (test_rc != PCRE2_ERROR_PARTIAL &&
+            (test_rc < 0) == (rc < 0) &&
+            (rc < 0 || ovector[1] == len))
+        {
+            return test;
+        }
+        test += step;
+        step *= 2;
+    }
+    return remaining + 1;
+}
+
+/*
+ * Returns the native matcher for a pattern or CLERI__REGEX_PCRE2 if the
+ * pattern is not recognized. For a string pattern, the quote and escape
+ * characters are set.
+ *
+ * Only the exact patterns are recognized since even a small difference in a
+ * pattern could change the result.
+ */
+static int REGEX_detect(const char * pattern, char * quote, char * escape)
+{
+    char buf[CLERI__RE_STRING_SZ];
+    const char * pt = pattern;
+
+    if (strcmp(pattern, CLERI__RE_INTEGER) == 0)
+    {
+        return CLERI__REGEX_INTEGER;
+    }
+    if (strcmp(pattern, CLERI__RE_FLOAT) == 0)
+    {
+        return CLERI__REGEX_FLOAT;
+    }
+    if (strcmp(pattern, CLERI__RE_IDENTIFIER) == 0)
+    {
+        return CLERI__REGEX_IDENTIFIER;
+    }
+
+    /* a string pattern starts with ^(q) where q might be escaped */
+    if (strncmp(pt, "^(", 2) != 0)
+    {
+        return CLERI__REGEX_PCRE2;
+    }
+    pt += (pt[2] == '\\') ? 3 : 2;
+    *quote = *pt;
+
+    /* the escape character follows (?=( and might be escaped as well */
+    pt = strstr(pt, "(?=(");
+    if (pt != NULL)
+    {
+        pt += (pt[4] == '\\') ? 5 : 4;
+    }
+    *escape = (pt == NULL) ? 0 : *pt;
+
+    /* generate the pattern for the characters found and compare */
+    return (
+        REGEX_string_pattern(buf, *quote, *escape) == 0 &&
+        strcmp(pattern, buf) == 0
+    ) ? CLERI__REGEX_STRING : CLERI__REGEX_PCRE2;
+}
+
+/*
+ * Write the pattern for a quoted string to buf, which must have room for at
+ * least CLERI__RE_STRING_SZ characters.
+ *
+ * Returns 0 if successful or -1 if the characters cannot be used.
+ */
+static int REGEX_string_pattern(char * buf, char quote, char escape)
+{
+    const char * special = "\\^$.|?*+()[]{}";
+    const char * q = strchr(special, quote) ? "\\" : "";
+    const char * e = strchr(special, escape) ? "\\" : "";
+
+    if (quote <= ' ' || quote > '~' || quote == escape ||
+        (escape != 0 && (escape <= ' ' || escape > '~')))
+    {
+        return -1;
+    }
+
+    if (escape == 0)
+    {
+        (void) sprintf(buf, "^(%s%c).*?\\1", q, quote);
+    }
+    else
+    {
+        (void) sprintf(
+                buf,
+                "^(%s%c)(?:(?=(%s%c?))\\2.)*?\\1",
+                q,
+                quote,
+                e,
+                escape);
+    }
+    return 0;
+}
+
+/*
+ * Set the minimal match length and the table with bytes which can start a
+ * match, using the information PCRE2 has found while compiling the pattern.
+ * When nothing is known, all bytes are accepted.
+ *
+ * The information is only used for anchored patterns since an unanchored
+ * pattern (like ^a|b) could still match further on in the string.
+ */
+static void REGEX_first(cleri_regex_t * regex)
+{
+    uint32_t options, minlength, tp, unit;
+    const uint8_t * bitmap;
+    pcre2_code * re = regex->regex;
+
+    memset(regex->first, 0xff, sizeof(regex->first));
+    regex->minlength = 0;
+
+    if (pcre2_pattern_info(re, PCRE2_INFO_ALLOPTIONS, &options) ||
+        (~options & PCRE2_ANCHORED))
+    {
+        return;
+    }
+
+    if (pcre2_pattern_info(re, PCRE2_INFO_MINLENGTH, &minlength) == 0)
+    {
+        regex->minlength = minlength;
+    }
+
+    /* type 1 means that each match starts with the same code unit */
+    if (pcre2_pattern_info(re, PCRE2_INFO_FIRSTCODETYPE, &tp) == 0 &&
+        tp == 1 &&
+        pcre2_pattern_info(re, PCRE2_INFO_FIRSTCODEUNIT, &unit) == 0)
+    {
+        /* the unit might be caseless, so accept both cases */
+        memset(regex->first, 0, sizeof(regex->first));
+        CLERI__REGEX_FIRST_SET(regex->first, unit);
+        if (unit < 0x80 && isalpha(unit))
+        {
+            CLERI__REGEX_FIRST_SET(regex->first, tolower(unit));
+            CLERI__REGEX_FIRST_SET(regex->first, toupper(unit));
+        }
+        return;
+    }
+
+    if (pcre2_pattern_info(re, PCRE2_INFO_FIRSTBITMAP, &bitmap) == 0 &&
+        bitmap != NULL)
+    {
+        memcpy(regex->first, bitmap, sizeof(regex->first));
+    }
+}
+
+/*
+ * Returns true when a pattern cannot match s, without calling PCRE2. In this
+ * case, argument examined is set to the number of bytes used for the result.
+ */
+static inline bool REGEX_reject(
+        cleri_regex_t * regex,
+        const char * s,
+        size_t n,
+        size_t * examined)
+{
+    if (n && !CLERI__REGEX_FIRST_HAS(regex->first, (unsigned char) s[0]))
+    {
+        *examined = 1;
+        return true;
+    }
+    if (n < regex->minlength)
+    {
+        *examined = n + 1;
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Returns the end of a sequence of digits in s, starting at position i.
+ */
+static inline size_t REGEX_digits(const char * s, size_t i, size_t n)
+{
+    while (i < n && REGEX_IS_DIGIT(s[i]))
+    {
+        ++i;
+    }
+    return i;
+}
+
+/*
+ * Native matcher for the patterns recognized by REGEX_detect().
+ *
+ * Returns 0 and sets len when s matches, or returns PCRE2_ERROR_NOMATCH when
+ * s does not match, like pcre2_match() does. Argument examined is set to the
+ * number of bytes from s which are used to find the result, which is the last
+ * inspected position plus one. (this is n + 1 when the result depends on the
+ * end of the string)
+ *
+ * The matchers follow the backtracking of PCRE2. For example the float
+ * pattern needs two digits, so it matches "12" in "12." but not "1.".
+ */
+static int REGEX_native(
+        cleri_regex_t * regex,
+        const char * s,
+        size_t n,
+        size_t * len,
+        size_t * examined)
+{
+    size_t i, j, k;
+
+    switch (regex->matcher)
+    {
+    case CLERI__REGEX_INTEGER:
+        i = (n && s[0] == '-') ? 1 : 0;
+        j = REGEX_digits(s, i, n);
+        *examined = j + 1;
+        *len = j;
+        return (j > i) ? 0 : PCRE2_ERROR_NOMATCH;
+
+    case CLERI__REGEX_FLOAT:
+        i = (n && s[0] == '-') ? 1 : 0;
+        j = REGEX_digits(s, i, n);
+        *examined = j + 1;
+        if (j == i)
+        {
+            return PCRE2_ERROR_NOMATCH;
+        }
+        if (j < n && s[j] == '.')
+        {
+            k = REGEX_digits(s, j + 1, n);
+            if (k > j + 1)
+            {
+                *examined = k + 1;
+                *len = k;
+                return 0;
+            }
+            *examined = j + 2;
+        }
+        /* without a fraction the last digit is used for the second part */
+        *len = j;
+        return (j - i >= 2) ? 0 : PCRE2_ERROR_NOMATCH;
+
+    case CLERI__REGEX_IDENTIFIER:
+        if (n == 0 || !REGEX_IS_ALPHA(s[0]))
+        {
+            *examined = 1;
+            return PCRE2_ERROR_NOMATCH;
+        }
+        i = 1;
+        while (i < n && (REGEX_IS_ALPHA(s[i]) || REGEX_IS_DIGIT(s[i])))
+        {
+            ++i;
+        }
+        *examined = i + 1;
+        *len = i;
+        return 0;
+
+    case CLERI__REGEX_STRING:
+        if (n == 0 || s[0] != regex->quote)
+        {
+            *examined = 1;
+            return PCRE2_ERROR_NOMATCH;
+        }
+        for (i = 1; i < n; ++i)
+        {
+            if (s[i] == regex->quote)
+            {
+                *examined = i + 1;
+                *len = i + 1;
+                return 0;
+            }
+            /* an escape character is followed by any but a new line */
+            if (regex->escape && s[i] == regex->escape && ++i == n)
+            {
+                break;
+            }
+            if (s[i] == '\n')
+            {
+                *examined = i + 1;
+                return PCRE2_ERROR_NOMATCH;
+            }
+        }
+        *examined = n + 1;
+        return PCRE2_ERROR_NOMATCH;
+    }
+
+    assert (0);
+    return PCRE2_ERROR_NOMATCH;
+}
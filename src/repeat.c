@@ -88,7 +88,8 @@ static cleri_node_t * REPEAT_parse(
     cleri_node_t * node;
     cleri_node_t * rnode;
     size_t i;
-    if ((node = cleri__node_new(cl_obj, parent->str + parent->len, 0)) == NULL)
+    node = cleri__node_new(pr, cl_obj, parent->str + parent->len, 0);
+    if (node == NULL)
     {
         pr->is_valid = -1;
         return NULL;
@@ -112,16 +113,16 @@ static cleri_node_t * REPEAT_parse(
 
     if (i < cl_obj->via.repeat->min)
     {
-        cleri__node_free(node);
+        cleri__node_free(pr, node);
         return NULL;
     }
     parent->len += node->len;
-    if (cleri__children_add(parent->children, node))
+    if (cleri__children_add(pr, parent, node))
     {
          /* error occurred, reverse changes set mg_node to NULL */
         pr->is_valid = -1;
         parent->len -= node->len;
-        cleri__node_free(node);
+        cleri__node_free(pr, node);
         node = NULL;
     }
     return node;
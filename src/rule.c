@@ -12,6 +12,8 @@
  */
 #include <cleri/rule.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 
 static void RULE_free(cleri_t * cl_object);
 static cleri_node_t * RULE_parse(
@@ -19,7 +21,12 @@ static cleri_node_t * RULE_parse(
         cleri_node_t * parent,
         cleri_t * cl_obj,
         cleri_rule_store_t * rule);
-static void RULE_tested_free(cleri_rule_tested_t * tested);
+static int RULE_tested_grow(
+        cleri_parse_t * pr,
+        cleri_rule_store_t * rule);
+static void RULE_tested_free(
+        cleri_parse_t * pr,
+        cleri_rule_store_t * rule);
 
 /*
  * Returns NULL in case an error has occurred.
@@ -64,36 +71,30 @@ cleri_t * cleri__rule(uint32_t gid, cleri_t * cl_obj)
  *  - CLERI_RULE_TRUE: a new test is created
  *  - CLERI_RULE_FALSE: no new test is created
  *  - CLERI_RULE_ERROR: an error occurred
+ *
+ * The tests are found using a hash table on the position. Tested positions
+ * are close to each other, so the position itself is used as hash.
  */
 cleri_rule_test_t cleri__rule_init(
+        cleri_parse_t * pr,
         cleri_rule_tested_t ** target,
-        cleri_rule_tested_t * tested,
+        cleri_rule_store_t * rule,
         const char * str)
 {
-    /*
-     * return true (1) when a new test is created, false (0) when not.
-     */
-    cleri_rule_tested_t * prev;
+    size_t i = (uintptr_t) str & rule->mask;
 
-    (*target) = tested;
-
-    if ((*target)->str == NULL)
+    for (; rule->tested[i] != NULL; i = (i + 1) & rule->mask)
     {
-        (*target)->str = str;
-        return CLERI_RULE_TRUE;
-    }
-
-    while ((*target) != NULL)
-    {
-        if ((*target)->str == str)
+        if (rule->tested[i]->str == str)
         {
+            *target = rule->tested[i];
             return CLERI_RULE_FALSE;
         }
-        prev = (*target);
-        (*target) = (*target)->next;
     }
-    *target = prev->next =
-            (cleri_rule_tested_t *) malloc(sizeof(cleri_rule_tested_t));
+
+    *target = (cleri_rule_tested_t *) cleri__arena_alloc(
+            pr->arena,
+            sizeof(cleri_rule_tested_t));
 
     if (*target == NULL)
     {
@@ -101,9 +102,12 @@ cleri_rule_test_t cleri__rule_init(
     }
     (*target)->str = str;
     (*target)->node = NULL;
-    (*target)->next = NULL;
+    rule->tested[i] = *target;
 
-    return CLERI_RULE_TRUE;
+    /* keep at least half of the slots empty; the test itself is not moved
+     * so target remains valid */
+    return (++rule->n * 2 > rule->mask && RULE_tested_grow(pr, rule)) ?
+            CLERI_RULE_ERROR : CLERI_RULE_TRUE;
 }
 
 static void RULE_free(cleri_t * cl_object)
@@ -125,25 +129,18 @@ static cleri_node_t * RULE_parse(
     cleri_node_t * rnode;
     cleri_rule_store_t nrule;
 
-    if ((node = cleri__node_new(cl_obj, parent->str + parent->len, 0)) == NULL)
+    node = cleri__node_new(pr, cl_obj, parent->str + parent->len, 0);
+    if (node == NULL)
     {
         pr->is_valid = -1;
         return NULL;
     }
 
     nrule.depth = 0;
-    nrule.tested = (cleri_rule_tested_t *) malloc(sizeof(cleri_rule_tested_t));
-
-    if (nrule.tested == NULL)
-    {
-        pr->is_valid = -1;
-        cleri__node_free(node);
-        return NULL;
-    }
-
-    nrule.tested->str = NULL;
-    nrule.tested->node = NULL;
-    nrule.tested->next = NULL;
+    nrule.n = 0;
+    nrule.mask = CLERI__RULE_TESTED_SZ - 1;
+    nrule.tested = nrule.slots;
+    memset(nrule.slots, 0, sizeof(nrule.slots));
     nrule.root_obj = cl_obj->via.rule->cl_obj;
 
     rnode = cleri__parse_walk(
@@ -156,39 +153,102 @@ static cleri_node_t * RULE_parse(
 
     if (rnode == NULL)
     {
-        cleri__node_free(node);
+        cleri__node_free(pr, node);
         node = NULL;
     }
     else
     {
         parent->len += node->len;
-        if (cleri__children_add(parent->children, node))
+        if (cleri__children_add(pr, parent, node))
         {
              /* error occurred, reverse changes set mg_node to NULL */
             pr->is_valid = -1;
             parent->len -= node->len;
-            cleri__node_free(node);
+            cleri__node_free(pr, node);
             node = NULL;
         }
     }
 
     /* cleanup rule */
-    RULE_tested_free(nrule.tested);
+    RULE_tested_free(pr, &nrule);
 
     return node;
 }
 
 /*
- * Cleanup rule tested
+ * Double the number of slots for the tests. The slots in the rule store are
+ * used until more slots are required. A larger table is allocated from the
+ * arena and returned to the arena when it is replaced or the rule is done.
+ *
+ * Returns 0 if successful or -1 in case of an error.
  */
-static void RULE_tested_free(cleri_rule_tested_t * tested)
+static int RULE_tested_grow(
+        cleri_parse_t * pr,
+        cleri_rule_store_t * rule)
 {
-    cleri_rule_tested_t * next;
-    while (tested != NULL)
+    size_t i, j, mask = rule->mask * 2 + 1;
+    size_t size = (mask + 1) * sizeof(cleri_rule_tested_t *);
+    cleri_rule_tested_t ** tested;
+
+    tested = (cleri_rule_tested_t **) cleri__arena_alloc(pr->arena, size);
+    if (tested == NULL)
+    {
+        return -1;
+    }
+
+    memset(tested, 0, size);
+
+    for (i = 0; i <= rule->mask; i++)
+    {
+        if (rule->tested[i] == NULL)
+        {
+            continue;
+        }
+        j = (uintptr_t) rule->tested[i]->str & mask;
+        while (tested[j] != NULL)
+        {
+            j = (j + 1) & mask;
+        }
+        tested[j] = rule->tested[i];
+    }
+
+    if (rule->tested != rule->slots)
+    {
+        cleri__arena_release(
+                pr->arena,
+                rule->tested,
+                (rule->mask + 1) * sizeof(cleri_rule_tested_t *));
+    }
+    rule->tested = tested;
+    rule->mask = mask;
+    return 0;
+}
+
+/*
+ * Cleanup rule tested. Each test holds a reference to the tested node.
+ */
+static void RULE_tested_free(
+        cleri_parse_t * pr,
+        cleri_rule_store_t * rule)
+{
+    size_t i;
+    for (i = 0; i <= rule->mask; i++)
+    {
+        if (rule->tested[i] != NULL)
+        {
+            cleri__node_free(pr, rule->tested[i]->node);
+            cleri__arena_release(
+                    pr->arena,
+                    rule->tested[i],
+                    sizeof(cleri_rule_tested_t));
+        }
+    }
+    if (rule->tested != rule->slots)
     {
-        next = tested->next;
-        free(tested);
-        tested = next;
+        cleri__arena_release(
+                pr->arena,
+                rule->tested,
+                (rule->mask + 1) * sizeof(cleri_rule_tested_t *));
     }
 }
 
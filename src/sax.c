@@ -0,0 +1,419 @@
+/*
+ * sax.c - parse a string and report the result using callbacks.
+ *
+ * changes
+ *  - initial version, 17-10-2026
+ *  - report elements while parsing, 17-10-2026
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <cleri/sax.h>
+#include <cleri/parse.h>
+#include <cleri/choice.h>
+#include <cleri/first.h>
+
+static int SAX_grow(cleri_sax_ctx_t * ctx);
+static void SAX_rules(
+        cleri_parse_t * pr,
+        cleri_sax_walk_t * walk,
+        cleri_t * cl_obj,
+        int mode);
+static bool SAX_sole(
+        cleri_parse_t * pr,
+        cleri_choice_t * choice,
+        cleri_t * cl_obj,
+        const char * str);
+static int SAX_flush(cleri_parse_t * pr, cleri_node_t * node);
+static void SAX_report(cleri_sax_ctx_t * ctx, cleri_node_t * node);
+static void SAX_children(cleri_sax_ctx_t * ctx, cleri_node_t * node);
+static void SAX_exit(cleri_sax_ctx_t * ctx, cleri_node_t * node);
+
+/*
+ * Returns 1 (TRUE) when the string is valid, 0 (FALSE) if not, or -1 in case
+ * of a memory allocation error. If pos is not NULL, pos will be set to the
+ * position where the string was successfully parsed.
+ *
+ * The callbacks in sax are called for each element in the parse tree, in the
+ * same order as a depth-first walk of the tree, but without creating the
+ * tree first. An element is reported while parsing as soon as it is complete
+ * and cannot be discarded anymore, after which the memory for the element is
+ * re-used. For example the items of a list which is not within a choice with
+ * other alternatives for the same position, or within a prio, are reported
+ * one by one. Other elements are reported once the element which might
+ * discard them is complete. Alternatives which are discarded, for example by
+ * a most greedy choice or a prio element, are never reported.
+ *
+ * Function on_enter is called with the start of the element and length 0
+ * since the element might still be parsed; on_exit is called with the full
+ * length. Each callback may be NULL.
+ *
+ * When the string is invalid, the callbacks might be called for the part of
+ * the string before the error, and not every element which is entered is
+ * exited. Expected elements and memoization are not used.
+ */
+int cleri_parse_sax(
+        cleri_grammar_t * grammar,
+        const char * str,
+        size_t len,
+        const cleri_sax_t * sax,
+        void * arg,
+        size_t * pos)
+{
+    int is_valid;
+    cleri_parse_t * pr;
+    cleri_sax_ctx_t ctx;
+
+    ctx.sax = sax;
+    ctx.arg = arg;
+    ctx.n = 0;
+    ctx.sz = 0;
+    ctx.walk = NULL;
+
+    pr = cleri__parse_sax(grammar, str, len, &ctx);
+    free(ctx.walk);
+
+    if (pr == NULL)
+    {
+        return -1;
+    }
+
+    is_valid = pr->is_valid;
+    if (pos != NULL)
+    {
+        *pos = pr->pos;
+    }
+
+    /* report what is left in the tree */
+    if (is_valid)
+    {
+        SAX_children(&ctx, pr->tree);
+    }
+
+    cleri_parse_free(pr);
+    return is_valid;
+}
+
+/*
+ * Walk a parser object like cleri__parse_walk() but keep track of the
+ * elements which are walking, see cleri__sax_commit().
+ *
+ * Returns a node or NULL. In case of an error pr->is_valid is set to -1.
+ */
+cleri_node_t * cleri__sax_walk(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_t * cl_obj,
+        cleri_rule_store_t * rule,
+        int mode)
+{
+    cleri_sax_ctx_t * ctx = pr->sax;
+    cleri_sax_walk_t * walk;
+    cleri_node_t * node;
+
+    if (ctx->n == ctx->sz && SAX_grow(ctx))
+    {
+        pr->is_valid = -1;
+        return NULL;
+    }
+
+    /* the same node walks each of its children from the same depth */
+    walk = ctx->walk + ctx->n;
+    if (walk->node != parent)
+    {
+        walk->node = parent;
+        walk->entered = false;
+    }
+    walk->fixed = ctx->n == 0 || (walk[-1].fixed && walk[-1].hold);
+    SAX_rules(pr, walk, cl_obj, mode);
+
+    ctx->n++;
+    node = (*cl_obj->parse_object)(pr, parent, cl_obj, rule);
+    ctx->n--;
+
+    return node;
+}
+
+/*
+ * Report a complete node which is added to parent, when the node can no
+ * longer be discarded. This is the case when parent keeps the node and each
+ * element which is walking fails when the element it walks fails, since
+ * such failure would make the string invalid anyway. Empty nodes are left
+ * in the tree since these might exist while the string is invalid.
+ *
+ * Returns 1 when the node is reported and released, 0 when the node must be
+ * added to parent or -1 in case of an error.
+ */
+int cleri__sax_commit(
+        cleri_parse_t * pr,
+        cleri_node_t * parent,
+        cleri_node_t * node)
+{
+    cleri_sax_ctx_t * ctx = pr->sax;
+    cleri_sax_walk_t * walk = ctx->walk;
+    size_t i, k = ctx->n - 1;
+
+    if (ctx->n == 0 ||
+        walk[k].node != parent ||
+        !walk[k].fixed ||
+        !walk[k].keep ||
+        node->len == 0)
+    {
+        return 0;
+    }
+
+    /* enter the walking elements, after the children which are before */
+    for (i = 0; i <= k; i++)
+    {
+        if (walk[i].entered)
+        {
+            continue;
+        }
+        if (i && SAX_flush(pr, walk[i - 1].node))
+        {
+            return -1;
+        }
+        if (walk[i].node->cl_obj != NULL && ctx->sax->on_enter != NULL)
+        {
+            (*ctx->sax->on_enter)(
+                    ctx->arg,
+                    walk[i].node->cl_obj->gid,
+                    walk[i].node->str,
+                    0);
+        }
+        walk[i].entered = true;
+    }
+
+    if (SAX_flush(pr, parent))
+    {
+        return -1;
+    }
+
+    /* the node might be entered already while walking its children */
+    if (ctx->n < ctx->sz && walk[ctx->n].node == node && walk[ctx->n].entered)
+    {
+        SAX_children(ctx, node);
+        SAX_exit(ctx, node);
+        walk[ctx->n].node = NULL;
+    }
+    else
+    {
+        SAX_report(ctx, node);
+    }
+
+    cleri__node_free(pr, node);
+    return 1;
+}
+
+/*
+ * Double the number of walking elements which can be tracked.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int SAX_grow(cleri_sax_ctx_t * ctx)
+{
+    size_t sz = (ctx->sz) ? ctx->sz * 2 : CLERI__SAX_WALK_SZ;
+    cleri_sax_walk_t * walk = (cleri_sax_walk_t *) realloc(
+            ctx->walk,
+            sizeof(cleri_sax_walk_t) * sz);
+
+    if (walk == NULL)
+    {
+        return -1;
+    }
+
+    memset(walk + ctx->sz, 0, sizeof(cleri_sax_walk_t) * (sz - ctx->sz));
+    ctx->walk = walk;
+    ctx->sz = sz;
+    return 0;
+}
+
+/*
+ * Set if the walking node fails when cl_obj fails (hold), and if the node
+ * keeps the result of cl_obj (keep). Only required for a fixed node.
+ */
+static void SAX_rules(
+        cleri_parse_t * pr,
+        cleri_sax_walk_t * walk,
+        cleri_t * cl_obj,
+        int mode)
+{
+    cleri_t * walking = walk->node->cl_obj;
+    cleri_choice_t * choice;
+
+    walk->hold = false;
+    walk->keep = false;
+
+    if (!walk->fixed)
+    {
+        return;
+    }
+
+    if (walking == NULL)
+    {
+        /* the root node */
+        walk->hold = true;
+        walk->keep = true;
+        return;
+    }
+
+    switch (walking->tp)
+    {
+    case CLERI_TP_SEQUENCE:
+    case CLERI_TP_RULE:
+        walk->hold = true;
+        walk->keep = true;
+        break;
+    case CLERI_TP_LIST:
+    case CLERI_TP_REPEAT:
+        /* the minimum number of children is not reached yet */
+        walk->hold = mode == CLERI__EXP_MODE_REQUIRED;
+        walk->keep = true;
+        break;
+    case CLERI_TP_OPTIONAL:
+        walk->keep = true;
+        break;
+    case CLERI_TP_CHOICE:
+        /* no other alternative can replace this one */
+        choice = walking->via.choice;
+        walk->hold = SAX_sole(
+                pr,
+                choice,
+                cl_obj,
+                walk->node->str + walk->node->len);
+        walk->keep = walk->hold || !choice->most_greedy;
+        break;
+    default:
+        /* a prio keeps the longest result, which might be found using
+         * the results of this one */
+        break;
+    }
+}
+
+/*
+ * Returns true when cl_obj is the only alternative of a choice which can
+ * match at str. Other alternatives are skipped by the choice in this case,
+ * see cleri__first_skip(). (expecting is not used)
+ */
+static bool SAX_sole(
+        cleri_parse_t * pr,
+        cleri_choice_t * choice,
+        cleri_t * cl_obj,
+        const char * str)
+{
+    cleri_olist_t * olist = choice->olist;
+    cleri_first_t * first = choice->first;
+    bool found = false;
+    size_t i;
+
+    if (first == NULL)
+    {
+        return false;
+    }
+
+    for (i = 0;
+         olist != NULL && olist->cl_obj != NULL;
+         i++, olist = olist->next)
+    {
+        if (!found && olist->cl_obj == cl_obj)
+        {
+            found = true;
+            continue;
+        }
+
+        /* for a first match choice only the next alternatives count */
+        if ((found || choice->most_greedy) && (
+                first[i].nullable || (
+                    cleri__parse_remaining(pr, str) &&
+                    CLERI__FIRST_HAS(first[i].bits, (unsigned char) *str)
+                )))
+        {
+            return false;
+        }
+    }
+    return found;
+}
+
+/*
+ * Report the children of a node and release them, so only children which
+ * are added later are left in the node.
+ *
+ * Returns 0 if successful or -1 in case of an error.
+ */
+static int SAX_flush(cleri_parse_t * pr, cleri_node_t * node)
+{
+    cleri_children_t * children;
+
+    if (node->nchildren == 0)
+    {
+        return 0;
+    }
+
+    children = cleri__children_new(pr);
+    if (children == NULL)
+    {
+        return -1;
+    }
+
+    SAX_children(pr->sax, node);
+    cleri__children_free(pr, node);
+    node->children = children;
+    node->nchildren = 0;
+    return 0;
+}
+
+/*
+ * Call the callbacks for a node and all its children.
+ */
+static void SAX_report(cleri_sax_ctx_t * ctx, cleri_node_t * node)
+{
+    cleri_t * cl_obj = node->cl_obj;
+
+    if (cl_obj->tp > CLERI_TP_THIS)
+    {
+        if (ctx->sax->on_terminal != NULL)
+        {
+            (*ctx->sax->on_terminal)(
+                    ctx->arg,
+                    cl_obj->gid,
+                    node->str,
+                    node->len);
+        }
+        return;
+    }
+
+    if (ctx->sax->on_enter != NULL)
+    {
+        (*ctx->sax->on_enter)(ctx->arg, cl_obj->gid, node->str, 0);
+    }
+
+    SAX_children(ctx, node);
+    SAX_exit(ctx, node);
+}
+
+/*
+ * Call the callbacks for the children of a node.
+ */
+static void SAX_children(cleri_sax_ctx_t * ctx, cleri_node_t * node)
+{
+    uint32_t i;
+
+    for (i = 0; node->children != NULL && i < node->nchildren; i++)
+    {
+        SAX_report(ctx, node->children[i].node);
+    }
+}
+
+/*
+ * Call on_exit for a node.
+ */
+static void SAX_exit(cleri_sax_ctx_t * ctx, cleri_node_t * node)
+{
+    if (ctx->sax->on_exit != NULL)
+    {
+        (*ctx->sax->on_exit)(
+                ctx->arg,
+                node->cl_obj->gid,
+                node->str,
+                node->len);
+    }
+}
@@ -96,7 +96,8 @@ static cleri_node_t * SEQUENCE_parse(
     cleri_node_t * rnode;
 
     olist = cl_obj->via.sequence->olist;
-    if ((node = cleri__node_new(cl_obj, parent->str + parent->len, 0)) == NULL)
+    node = cleri__node_new(pr, cl_obj, parent->str + parent->len, 0);
+    if (node == NULL)
     {
         pr->is_valid = -1;
         return NULL;
@@ -112,19 +113,19 @@ static cleri_node_t * SEQUENCE_parse(
                 CLERI__EXP_MODE_REQUIRED);
         if (rnode == NULL)
         {
-            cleri__node_free(node);
+            cleri__node_free(pr, node);
             return NULL;
         }
         olist = olist->next;
     }
 
     parent->len += node->len;
-    if (cleri__children_add(parent->children, node))
+    if (cleri__children_add(pr, parent, node))
     {
         /* error occurred, reverse changes set mg_node to NULL */
         pr->is_valid = -1;
         parent->len -= node->len;
-        cleri__node_free(node);
+        cleri__node_free(pr, node);
         node = NULL;
     }
     return node;
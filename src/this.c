@@ -48,10 +48,10 @@ static cleri_node_t * cleri_parse_this(
     cleri_rule_tested_t * tested;
     const char * str = parent->str + parent->len;
 
-    switch (cleri__rule_init(&tested, rule->tested, str))
+    switch (cleri__rule_init(pr, &tested, rule, str))
     {
     case CLERI_RULE_TRUE:
-        if ((node = cleri__node_new(cl_obj, str, 0)) == NULL)
+        if ((node = cleri__node_new(pr, cl_obj, str, 0)) == NULL)
         {
             pr->is_valid = -1;
             return NULL;
@@ -65,7 +65,7 @@ static cleri_node_t * cleri_parse_this(
 
         if (tested->node == NULL)
         {
-            cleri__node_free(node);
+            cleri__node_free(pr, node);
             return NULL;
         }
         break;
@@ -87,12 +87,12 @@ static cleri_node_t * cleri_parse_this(
     }
 
     parent->len += tested->node->len;
-    if (cleri__children_add(parent->children, node))
+    if (cleri__children_add(pr, parent, node))
     {
          /* error occurred, reverse changes set mg_node to NULL */
         pr->is_valid = -1;
         parent->len -=  tested->node->len;
-        cleri__node_free(node);
+        cleri__node_free(pr, node);
         node = NULL;
     }
     return node;
@@ -74,23 +74,34 @@ static cleri_node_t * TOKEN_parse(
 {
     cleri_node_t * node = NULL;
     const char * str = parent->str + parent->len;
-    if (strncmp(
+    size_t remaining = cleri__parse_remaining(pr, str);
+
+    /* the token is compared or, at the end, the end of the string is */
+    cleri__parse_examined(
+            pr,
+            str,
+            (cl_obj->via.token->len <= remaining) ?
+                    cl_obj->via.token->len : remaining + 1);
+
+    if (cl_obj->via.token->len <= remaining &&
+        memcmp(
             cl_obj->via.token->token,
             str,
             cl_obj->via.token->len) == 0)
     {
         if ((node = cleri__node_new(
+                pr,
                 cl_obj,
                 str,
                 cl_obj->via.token->len)) != NULL)
         {
             parent->len += node->len;
-            if (cleri__children_add(parent->children, node))
+            if (cleri__children_add(pr, parent, node))
             {
                  /* error occurred, reverse changes set mg_node to NULL */
                 pr->is_valid = -1;
                 parent->len -= node->len;
-                cleri__node_free(node);
+                cleri__node_free(pr, node);
                 node = NULL;
             }
         }
@@ -28,6 +28,7 @@ static int TOKENS_list_add(
         const char * token,
         size_t len);
 static void TOKENS_list_free(cleri_tlist_t * tlist);
+static void TOKENS_first(cleri_tokens_t * tokens);
 
 /*
  * Returns NULL in case an error has occurred.
@@ -77,6 +78,7 @@ cleri_t * cleri_tokens(uint32_t gid, const char * tokens)
 
     cl_object->via.tokens->tlist->token = NULL;
     cl_object->via.tokens->tlist->next = NULL;
+    cl_object->via.tokens->tlist->next_first = NULL;
     cl_object->via.tokens->tlist->len = 0;
 
     pt = cl_object->via.tokens->tokens;
@@ -115,6 +117,8 @@ cleri_t * cleri_tokens(uint32_t gid, const char * tokens)
     assert (cl_object->via.tokens->tlist->token != NULL);
 #endif
 
+    TOKENS_first(cl_object->via.tokens);
+
     return cl_object;
 }
 
@@ -141,21 +145,31 @@ static cleri_node_t * TOKENS_parse(
     cleri_node_t * node = NULL;
     const char * str = parent->str + parent->len;
     cleri_tlist_t * tlist = cl_obj->via.tokens->tlist;
+    size_t remaining = cleri__parse_remaining(pr, str);
+
+    /* the first token is the longest token */
+    cleri__parse_examined(
+            pr,
+            str,
+            (tlist->len <= remaining) ? tlist->len : remaining + 1);
+
+    /* only the tokens starting with the next byte need to be compared */
+    tlist = remaining ? cl_obj->via.tokens->first[(unsigned char) *str] : NULL;
 
-    /* we can trust that at least one token is in the list */
-    for (; tlist != NULL; tlist = tlist->next)
+    for (; tlist != NULL; tlist = tlist->next_first)
     {
-        if (strncmp(tlist->token, str, tlist->len) == 0)
+        if (tlist->len <= remaining &&
+            memcmp(tlist->token + 1, str + 1, tlist->len - 1) == 0)
         {
-            if ((node = cleri__node_new(cl_obj, str, tlist->len)) != NULL)
+            if ((node = cleri__node_new(pr, cl_obj, str, tlist->len)) != NULL)
             {
                 parent->len += node->len;
-                if (cleri__children_add(parent->children, node))
+                if (cleri__children_add(pr, parent, node))
                 {
                      /* error occurred, reverse changes set mg_node to NULL */
                     pr->is_valid = -1;
                     parent->len -= node->len;
-                    cleri__node_free(node);
+                    cleri__node_free(pr, node);
                     node = NULL;
                 }
             }
@@ -201,6 +215,7 @@ static int TOKENS_list_add(
     }
     tmp->len = len;
     tmp->token = token;
+    tmp->next_first = NULL;
 
 
     while (current != NULL && len <= current->len)
@@ -237,3 +252,34 @@ static void TOKENS_list_free(cleri_tlist_t * tlist)
     }
 }
 
+
+/*
+ * Fill the table with tokens by first byte. For each byte, the tokens are
+ * linked in the same order as the token list, so the largest token is still
+ * tried first.
+ */
+static void TOKENS_first(cleri_tokens_t * tokens)
+{
+    cleri_tlist_t * tlist, * last[256] = {NULL};
+    unsigned char c;
+
+    memset(tokens->first, 0, sizeof(tokens->first));
+
+    for (tlist = tokens->tlist; tlist != NULL; tlist = tlist->next)
+    {
+        if (tlist->token == NULL)
+        {
+            continue;
+        }
+        c = (unsigned char) *tlist->token;
+        if (last[c] == NULL)
+        {
+            tokens->first[c] = tlist;
+        }
+        else
+        {
+            last[c]->next_first = tlist;
+        }
+        last[c] = tlist;
+    }
+}